@@ -0,0 +1,132 @@
+#include "culling.h"
+
+#include <cmath>
+
+// Widest SIMD the compiler targets, define CULL_NO_SIMD to always use the
+// scalar path. AVX has to be turned on explicitly (-mavx, /arch:AVX).
+#if !defined(CULL_NO_SIMD)
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CULL_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || \
+        (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CULL_SIMD_SSE2
+#endif
+#endif
+
+Frustum::Frustum() {
+    // Everything passes until a matrix is set
+    for (int i = 0; i < 6; i++) {
+        normalX[i] = 0.0f;
+        normalY[i] = 0.0f;
+        normalZ[i] = 0.0f;
+        distance[i] = 1.0f;
+    }
+}
+
+void Frustum::setViewProjection(const float* m) {
+    // Gribb and Hartmann: each plane is the last row of the matrix plus or
+    // minus one of the others. Element (row, column) is m[column * 4 + row].
+    for (int i = 0; i < 6; i++) {
+        int row = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+        float a = m[3] + sign * m[row];
+        float b = m[7] + sign * m[4 + row];
+        float c = m[11] + sign * m[8 + row];
+        float d = m[15] + sign * m[12 + row];
+
+        float length = std::sqrt(a * a + b * b + c * c);
+        float scale = length > 0.0f ? 1.0f / length : 0.0f;
+        normalX[i] = a * scale;
+        normalY[i] = b * scale;
+        normalZ[i] = c * scale;
+        distance[i] = d * scale;
+    }
+}
+
+size_t Frustum::cullSpheres(const SphereArrays& spheres,
+        size_t count,
+        unsigned int* visible) const {
+    size_t visibleCount = 0;
+    size_t i = 0;
+
+#if defined(CULL_SIMD_AVX) || defined(CULL_SIMD_SSE2)
+#if defined(CULL_SIMD_AVX)
+    const size_t lanes = 8;
+    __m256 planeX[6], planeY[6], planeZ[6], planeD[6];
+    for (int p = 0; p < 6; p++) {
+        planeX[p] = _mm256_set1_ps(normalX[p]);
+        planeY[p] = _mm256_set1_ps(normalY[p]);
+        planeZ[p] = _mm256_set1_ps(normalZ[p]);
+        planeD[p] = _mm256_set1_ps(distance[p]);
+    }
+#else
+    const size_t lanes = 4;
+    __m128 planeX[6], planeY[6], planeZ[6], planeD[6];
+    for (int p = 0; p < 6; p++) {
+        planeX[p] = _mm_set1_ps(normalX[p]);
+        planeY[p] = _mm_set1_ps(normalY[p]);
+        planeZ[p] = _mm_set1_ps(normalZ[p]);
+        planeD[p] = _mm_set1_ps(distance[p]);
+    }
+#endif
+
+    for (; i + lanes <= count; i += lanes) {
+#if defined(CULL_SIMD_AVX)
+        __m256 x = _mm256_loadu_ps(spheres.x + i);
+        __m256 y = _mm256_loadu_ps(spheres.y + i);
+        __m256 z = _mm256_loadu_ps(spheres.z + i);
+        __m256 negRadius = _mm256_sub_ps(
+                _mm256_setzero_ps(), _mm256_loadu_ps(spheres.radius + i));
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            __m256 d = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(x, planeX[p]),
+                            _mm256_mul_ps(y, planeY[p])),
+                    _mm256_add_ps(_mm256_mul_ps(z, planeZ[p]), planeD[p]));
+            inside = _mm256_and_ps(
+                    inside, _mm256_cmp_ps(d, negRadius, _CMP_GE_OQ));
+        }
+        unsigned int mask = (unsigned int)_mm256_movemask_ps(inside);
+#else
+        __m128 x = _mm_loadu_ps(spheres.x + i);
+        __m128 y = _mm_loadu_ps(spheres.y + i);
+        __m128 z = _mm_loadu_ps(spheres.z + i);
+        __m128 negRadius = _mm_sub_ps(
+                _mm_setzero_ps(), _mm_loadu_ps(spheres.radius + i));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, planeX[p]),
+                                          _mm_mul_ps(y, planeY[p])),
+                    _mm_add_ps(_mm_mul_ps(z, planeZ[p]), planeD[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negRadius));
+        }
+        unsigned int mask = (unsigned int)_mm_movemask_ps(inside);
+#endif
+        if (mask == 0) {
+            continue;
+        }
+        // Branchless compaction: every lane writes its index, only the
+        // visible ones advance. The slot written is never past the lane's
+        // own index, so visible only needs room for count entries.
+        for (size_t lane = 0; lane < lanes; lane++) {
+            visible[visibleCount] = (unsigned int)(i + lane);
+            visibleCount += (mask >> lane) & 1u;
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; p++) {
+            float d = spheres.x[i] * normalX[p] + spheres.y[i] * normalY[p] +
+                      spheres.z[i] * normalZ[p] + distance[p];
+            inside = d >= -spheres.radius[i];
+        }
+        if (inside) {
+            visible[visibleCount++] = (unsigned int)i;
+        }
+    }
+    return visibleCount;
+}
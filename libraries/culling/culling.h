@@ -0,0 +1,39 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include <cstddef>
+
+// Bounding spheres laid out structure-of-arrays, so a batch of 4 (SSE) or
+// 8 (AVX) spheres is one load per field
+struct SphereArrays {
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* radius;
+};
+
+// View frustum as six normalized planes (left, right, bottom, top, near,
+// far) pointing inwards, a point p is inside a plane when
+// dot(normal, p) + d >= 0
+class Frustum {
+  public:
+    Frustum();
+
+    // viewProjection is projection * view, column major (glm::value_ptr)
+    void setViewProjection(const float* viewProjection);
+
+    // Writes the indices of the spheres that intersect the frustum to
+    // visible (room for count indices), in increasing order, and returns
+    // how many there are. Spheres that straddle a corner can pass, like
+    // with any plane-by-plane test.
+    size_t cullSpheres(const SphereArrays& spheres,
+            size_t count,
+            unsigned int* visible) const;
+
+  private:
+    float normalX[6];
+    float normalY[6];
+    float normalZ[6];
+    float distance[6];
+};
+#endif
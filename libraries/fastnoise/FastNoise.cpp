@@ -30,6 +30,22 @@
 #include <math.h>
 #include <assert.h>
 #include <random>
+#include <vector>
+#include <algorithm>
+
+// SIMD lanes used by FillGrid2D() and FillGrid3D(), define FN_NO_SIMD to always use the scalar path
+#if !defined(FN_USE_DOUBLES) && !defined(FN_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#define FN_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FN_SIMD_NEON
+#endif
+#endif
 
 const FN_DECIMAL GRAD_X[] =
 {
@@ -185,6 +201,8 @@ static FN_DECIMAL FastAbs(FN_DECIMAL f) { return fabs(f); }
 static FN_DECIMAL Lerp(FN_DECIMAL a, FN_DECIMAL b, FN_DECIMAL t) { return a + t * (b - a); }
 static FN_DECIMAL InterpHermiteFunc(FN_DECIMAL t) { return t*t*(3 - 2 * t); }
 static FN_DECIMAL InterpQuinticFunc(FN_DECIMAL t) { return t*t*t*(t*(t * 6 - 15) + 10); }
+static FN_DECIMAL InterpHermiteFuncDeriv(FN_DECIMAL t) { return 6 * t * (1 - t); }
+static FN_DECIMAL InterpQuinticFuncDeriv(FN_DECIMAL t) { return 30 * t*t*(t*(t - 2) + 1); }
 static FN_DECIMAL CubicLerp(FN_DECIMAL a, FN_DECIMAL b, FN_DECIMAL c, FN_DECIMAL d, FN_DECIMAL t)
 {
 	FN_DECIMAL p = (d - c) - (a - b);
@@ -195,6 +213,10 @@ void FastNoise::SetSeed(int seed)
 {
 	m_seed = seed;
 
+	// The integer hash reads the seed as it is, the table is rebuilt by SetHashType()
+	if (m_hashType == IntegerHash)
+		return;
+
 	std::mt19937 gen(seed);
 
 	for (int i = 0; i < 256; i++)
@@ -211,6 +233,23 @@ void FastNoise::SetSeed(int seed)
 	}
 }
 
+void FastNoise::SetHashType(HashType hashType)
+{
+	m_hashType = hashType;
+
+	if (m_hashType == PermutationTable)
+	{
+		SetSeed(m_seed);
+	}
+	else
+	{
+		// The fractals still take their octave offsets from m_perm, keep them independent of
+		// whichever seed the table was last shuffled for
+		for (int i = 0; i < 512; i++)
+			m_perm[i] = (unsigned char)i;
+	}
+}
+
 void FastNoise::CalculateFractalBounding()
 {
 	float amp = m_gain;
@@ -232,37 +271,88 @@ void FastNoise::SetCellularDistance2Indicies(int cellularDistanceIndex0, int cel
 	m_cellularDistanceIndex1 = fmin(fmax(m_cellularDistanceIndex1, 0), FN_CELLULAR_INDEX_MAX);
 }
 
-unsigned char FastNoise::Index2D_12(unsigned char offset, int x, int y)
+// Hashing
+#define X_PRIME 1619
+#define Y_PRIME 31337
+#define Z_PRIME 6971
+#define W_PRIME 1013
+#define OFFSET_PRIME 0x27d4eb2du
+
+// Integer hash backend: the coordinates are mixed into the seed like ValCoord2D() does, then
+// scrambled with multiplies and xorshifts. Every step only depends on the previous one through
+// arithmetic, so it pipelines and vectorizes where the table's chained loads can't.
+static unsigned int HashSeed(int seed, unsigned char offset)
+{
+	return (unsigned int)seed ^ offset * OFFSET_PRIME;
+}
+static unsigned int HashFinish(unsigned int n)
+{
+	n ^= n >> 15;
+	n *= 0x2c1b3c6du;
+	n ^= n >> 12;
+	n *= 0x297a2d39u;
+	return n ^ (n >> 15);
+}
+static unsigned int HashCoord(unsigned int n, int x, int y)
+{
+	return HashFinish(n ^ X_PRIME * (unsigned int)x ^ Y_PRIME * (unsigned int)y);
+}
+static unsigned int HashCoord(unsigned int n, int x, int y, int z)
+{
+	return HashFinish(n ^ X_PRIME * (unsigned int)x ^ Y_PRIME * (unsigned int)y ^ Z_PRIME * (unsigned int)z);
+}
+static unsigned int HashCoord(unsigned int n, int x, int y, int z, int w)
+{
+	return HashFinish(n ^ X_PRIME * (unsigned int)x ^ Y_PRIME * (unsigned int)y ^ Z_PRIME * (unsigned int)z ^ W_PRIME * (unsigned int)w);
+}
+// The top bits are the best mixed, scale them into the table sizes without a modulo
+static unsigned char HashTo12(unsigned int hash) { return (unsigned char)(((hash >> 16) * 12) >> 16); }
+static unsigned char HashTo32(unsigned int hash) { return (unsigned char)(hash >> 27); }
+static unsigned char HashTo256(unsigned int hash) { return (unsigned char)(hash >> 24); }
+
+unsigned char FastNoise::Index2D_12(unsigned char offset, int x, int y) const
 {
+	if (m_hashType == IntegerHash)
+		return HashTo12(HashCoord(HashSeed(m_seed, offset), x, y));
+
 	return m_perm12[(x & 0xff) + m_perm[(y & 0xff) + offset]];
 }
-unsigned char FastNoise::Index3D_12(unsigned char offset, int x, int y, int z)
+unsigned char FastNoise::Index3D_12(unsigned char offset, int x, int y, int z) const
 {
+	if (m_hashType == IntegerHash)
+		return HashTo12(HashCoord(HashSeed(m_seed, offset), x, y, z));
+
 	return m_perm12[(x & 0xff) + m_perm[(y & 0xff) + m_perm[(z & 0xff) + offset]]];
 }
-unsigned char FastNoise::Index4D_32(unsigned char offset, int x, int y, int z, int w)
+unsigned char FastNoise::Index4D_32(unsigned char offset, int x, int y, int z, int w) const
 {
+	if (m_hashType == IntegerHash)
+		return HashTo32(HashCoord(HashSeed(m_seed, offset), x, y, z, w));
+
 	return m_perm[(x & 0xff) + m_perm[(y & 0xff) + m_perm[(z & 0xff) + m_perm[(w & 0xff) + offset]]]] & 31;
 }
-unsigned char FastNoise::Index2D_256(unsigned char offset, int x, int y)
+unsigned char FastNoise::Index2D_256(unsigned char offset, int x, int y) const
 {
+	if (m_hashType == IntegerHash)
+		return HashTo256(HashCoord(HashSeed(m_seed, offset), x, y));
+
 	return m_perm[(x & 0xff) + m_perm[(y & 0xff) + offset]];
 }
-unsigned char FastNoise::Index3D_256(unsigned char offset, int x, int y, int z)
+unsigned char FastNoise::Index3D_256(unsigned char offset, int x, int y, int z) const
 {
+	if (m_hashType == IntegerHash)
+		return HashTo256(HashCoord(HashSeed(m_seed, offset), x, y, z));
+
 	return m_perm[(x & 0xff) + m_perm[(y & 0xff) + m_perm[(z & 0xff) + offset]]];
 }
-unsigned char FastNoise::Index4D_256(unsigned char offset, int x, int y, int z, int w)
+unsigned char FastNoise::Index4D_256(unsigned char offset, int x, int y, int z, int w) const
 {
+	if (m_hashType == IntegerHash)
+		return HashTo256(HashCoord(HashSeed(m_seed, offset), x, y, z, w));
+
 	return m_perm[(x & 0xff) + m_perm[(y & 0xff) + m_perm[(z & 0xff) + m_perm[(w & 0xff) + offset]]]];
 }
 
-// Hashing
-#define X_PRIME 1619
-#define Y_PRIME 31337
-#define Z_PRIME 6971
-#define W_PRIME 1013
-
 static FN_DECIMAL ValCoord2D(int seed, int x, int y)
 {
 	int n = seed;
@@ -291,35 +381,35 @@ static FN_DECIMAL ValCoord4D(int seed, int x, int y, int z, int w)
 	return (n * n * n * 60493) / FN_DECIMAL(2147483648);
 }
 
-FN_DECIMAL FastNoise::ValCoord2DFast(unsigned char offset, int x, int y)
+FN_DECIMAL FastNoise::ValCoord2DFast(unsigned char offset, int x, int y) const
 {
 	return VAL_LUT[Index2D_256(offset, x, y)];
 }
-FN_DECIMAL FastNoise::ValCoord3DFast(unsigned char offset, int x, int y, int z)
+FN_DECIMAL FastNoise::ValCoord3DFast(unsigned char offset, int x, int y, int z) const
 {
 	return VAL_LUT[Index3D_256(offset, x, y, z)];
 }
 
-FN_DECIMAL FastNoise::GradCoord2D(unsigned char offset, int x, int y, FN_DECIMAL xd, FN_DECIMAL yd)
+FN_DECIMAL FastNoise::GradCoord2D(unsigned char offset, int x, int y, FN_DECIMAL xd, FN_DECIMAL yd) const
 {
 	unsigned char lutPos = Index2D_12(offset, x, y);
 
 	return xd*GRAD_X[lutPos] + yd*GRAD_Y[lutPos];
 }
-FN_DECIMAL FastNoise::GradCoord3D(unsigned char offset, int x, int y, int z, FN_DECIMAL xd, FN_DECIMAL yd, FN_DECIMAL zd)
+FN_DECIMAL FastNoise::GradCoord3D(unsigned char offset, int x, int y, int z, FN_DECIMAL xd, FN_DECIMAL yd, FN_DECIMAL zd) const
 {
 	unsigned char lutPos = Index3D_12(offset, x, y, z);
 
 	return xd*GRAD_X[lutPos] + yd*GRAD_Y[lutPos] + zd*GRAD_Z[lutPos];
 }
-FN_DECIMAL FastNoise::GradCoord4D(unsigned char offset, int x, int y, int z, int w, FN_DECIMAL xd, FN_DECIMAL yd, FN_DECIMAL zd, FN_DECIMAL wd)
+FN_DECIMAL FastNoise::GradCoord4D(unsigned char offset, int x, int y, int z, int w, FN_DECIMAL xd, FN_DECIMAL yd, FN_DECIMAL zd, FN_DECIMAL wd) const
 {
 	unsigned char lutPos = Index4D_32(offset, x, y, z, w) << 2;
 
 	return xd*GRAD_4D[lutPos] + yd*GRAD_4D[lutPos + 1] + zd*GRAD_4D[lutPos + 2] + wd*GRAD_4D[lutPos + 3];
 }
 
-FN_DECIMAL FastNoise::GetNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::GetNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	x *= m_frequency;
 	y *= m_frequency;
@@ -398,7 +488,7 @@ FN_DECIMAL FastNoise::GetNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
 	}
 }
 
-FN_DECIMAL FastNoise::GetNoise(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::GetNoise(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	x *= m_frequency;
 	y *= m_frequency;
@@ -470,7 +560,7 @@ FN_DECIMAL FastNoise::GetNoise(FN_DECIMAL x, FN_DECIMAL y)
 }
 
 // White Noise
-FN_DECIMAL FastNoise::GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w)
+FN_DECIMAL FastNoise::GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w) const
 {
 	return ValCoord4D(m_seed,
 		*reinterpret_cast<int*>(&x) ^ (*reinterpret_cast<int*>(&x) >> 16),
@@ -479,7 +569,7 @@ FN_DECIMAL FastNoise::GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN
 		*reinterpret_cast<int*>(&w) ^ (*reinterpret_cast<int*>(&w) >> 16));
 }
 
-FN_DECIMAL FastNoise::GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	return ValCoord3D(m_seed,
 		*reinterpret_cast<int*>(&x) ^ (*reinterpret_cast<int*>(&x) >> 16),
@@ -487,30 +577,30 @@ FN_DECIMAL FastNoise::GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
 		*reinterpret_cast<int*>(&z) ^ (*reinterpret_cast<int*>(&z) >> 16));
 }
 
-FN_DECIMAL FastNoise::GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	return ValCoord2D(m_seed,
 		*reinterpret_cast<int*>(&x) ^ (*reinterpret_cast<int*>(&x) >> 16),
 		*reinterpret_cast<int*>(&y) ^ (*reinterpret_cast<int*>(&y) >> 16));
 }
 
-FN_DECIMAL FastNoise::GetWhiteNoiseInt(int x, int y, int z, int w)
+FN_DECIMAL FastNoise::GetWhiteNoiseInt(int x, int y, int z, int w) const
 {
 	return ValCoord4D(m_seed, x, y, z, w);
 }
 
-FN_DECIMAL FastNoise::GetWhiteNoiseInt(int x, int y, int z)
+FN_DECIMAL FastNoise::GetWhiteNoiseInt(int x, int y, int z) const
 {
 	return ValCoord3D(m_seed, x, y, z);
 }
 
-FN_DECIMAL FastNoise::GetWhiteNoiseInt(int x, int y)
+FN_DECIMAL FastNoise::GetWhiteNoiseInt(int x, int y) const
 {
 	return ValCoord2D(m_seed, x, y);
 }
 
 // Value Noise
-FN_DECIMAL FastNoise::GetValueFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::GetValueFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	x *= m_frequency;
 	y *= m_frequency;
@@ -529,7 +619,7 @@ FN_DECIMAL FastNoise::GetValueFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
 	}
 }
 
-FN_DECIMAL FastNoise::SingleValueFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SingleValueFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	FN_DECIMAL sum = SingleValue(m_perm[0], x, y, z);
 	FN_DECIMAL amp = 1;
@@ -548,7 +638,7 @@ FN_DECIMAL FastNoise::SingleValueFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIM
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SingleValueFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SingleValueFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	FN_DECIMAL sum = FastAbs(SingleValue(m_perm[0], x, y, z)) * 2 - 1;
 	FN_DECIMAL amp = 1;
@@ -567,7 +657,7 @@ FN_DECIMAL FastNoise::SingleValueFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DE
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SingleValueFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SingleValueFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	FN_DECIMAL sum = 1 - FastAbs(SingleValue(m_perm[0], x, y, z));
 	FN_DECIMAL amp = 1;
@@ -586,12 +676,12 @@ FN_DECIMAL FastNoise::SingleValueFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, F
 	return sum;
 }
 
-FN_DECIMAL FastNoise::GetValue(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::GetValue(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	return SingleValue(0, x * m_frequency, y * m_frequency, z * m_frequency);
 }
 
-FN_DECIMAL FastNoise::SingleValue(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SingleValue(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	int x0 = FastFloor(x);
 	int y0 = FastFloor(y);
@@ -631,7 +721,7 @@ FN_DECIMAL FastNoise::SingleValue(unsigned char offset, FN_DECIMAL x, FN_DECIMAL
 	return Lerp(yf0, yf1, zs);
 }
 
-FN_DECIMAL FastNoise::GetValueFractal(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::GetValueFractal(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	x *= m_frequency;
 	y *= m_frequency;
@@ -649,7 +739,7 @@ FN_DECIMAL FastNoise::GetValueFractal(FN_DECIMAL x, FN_DECIMAL y)
 	}
 }
 
-FN_DECIMAL FastNoise::SingleValueFractalFBM(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleValueFractalFBM(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	FN_DECIMAL sum = SingleValue(m_perm[0], x, y);
 	FN_DECIMAL amp = 1;
@@ -667,7 +757,7 @@ FN_DECIMAL FastNoise::SingleValueFractalFBM(FN_DECIMAL x, FN_DECIMAL y)
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SingleValueFractalBillow(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleValueFractalBillow(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	FN_DECIMAL sum = FastAbs(SingleValue(m_perm[0], x, y)) * 2 - 1;
 	FN_DECIMAL amp = 1;
@@ -684,7 +774,7 @@ FN_DECIMAL FastNoise::SingleValueFractalBillow(FN_DECIMAL x, FN_DECIMAL y)
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SingleValueFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleValueFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	FN_DECIMAL sum = 1 - FastAbs(SingleValue(m_perm[0], x, y));
 	FN_DECIMAL amp = 1;
@@ -702,12 +792,12 @@ FN_DECIMAL FastNoise::SingleValueFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y)
 	return sum;
 }
 
-FN_DECIMAL FastNoise::GetValue(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::GetValue(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	return SingleValue(0, x * m_frequency, y * m_frequency);
 }
 
-FN_DECIMAL FastNoise::SingleValue(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleValue(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y) const
 {
 	int x0 = FastFloor(x);
 	int y0 = FastFloor(y);
@@ -738,7 +828,7 @@ FN_DECIMAL FastNoise::SingleValue(unsigned char offset, FN_DECIMAL x, FN_DECIMAL
 }
 
 // Perlin Noise
-FN_DECIMAL FastNoise::GetPerlinFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::GetPerlinFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	x *= m_frequency;
 	y *= m_frequency;
@@ -757,7 +847,7 @@ FN_DECIMAL FastNoise::GetPerlinFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
 	}
 }
 
-FN_DECIMAL FastNoise::SinglePerlinFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SinglePerlinFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	FN_DECIMAL sum = SinglePerlin(m_perm[0], x, y, z);
 	FN_DECIMAL amp = 1;
@@ -776,7 +866,7 @@ FN_DECIMAL FastNoise::SinglePerlinFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECI
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SinglePerlinFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SinglePerlinFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	FN_DECIMAL sum = FastAbs(SinglePerlin(m_perm[0], x, y, z)) * 2 - 1;
 	FN_DECIMAL amp = 1;
@@ -795,7 +885,7 @@ FN_DECIMAL FastNoise::SinglePerlinFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_D
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SinglePerlinFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SinglePerlinFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	FN_DECIMAL sum = 1 - FastAbs(SinglePerlin(m_perm[0], x, y, z));
 	FN_DECIMAL amp = 1;
@@ -814,12 +904,12 @@ FN_DECIMAL FastNoise::SinglePerlinFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y,
 	return sum;
 }
 
-FN_DECIMAL FastNoise::GetPerlin(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::GetPerlin(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	return SinglePerlin(0, x * m_frequency, y * m_frequency, z * m_frequency);
 }
 
-FN_DECIMAL FastNoise::SinglePerlin(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SinglePerlin(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	int x0 = FastFloor(x);
 	int y0 = FastFloor(y);
@@ -866,7 +956,7 @@ FN_DECIMAL FastNoise::SinglePerlin(unsigned char offset, FN_DECIMAL x, FN_DECIMA
 	return Lerp(yf0, yf1, zs);
 }
 
-FN_DECIMAL FastNoise::GetPerlinFractal(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::GetPerlinFractal(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	x *= m_frequency;
 	y *= m_frequency;
@@ -884,7 +974,7 @@ FN_DECIMAL FastNoise::GetPerlinFractal(FN_DECIMAL x, FN_DECIMAL y)
 	}
 }
 
-FN_DECIMAL FastNoise::SinglePerlinFractalFBM(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SinglePerlinFractalFBM(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	FN_DECIMAL sum = SinglePerlin(m_perm[0], x, y);
 	FN_DECIMAL amp = 1;
@@ -902,7 +992,7 @@ FN_DECIMAL FastNoise::SinglePerlinFractalFBM(FN_DECIMAL x, FN_DECIMAL y)
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SinglePerlinFractalBillow(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SinglePerlinFractalBillow(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	FN_DECIMAL sum = FastAbs(SinglePerlin(m_perm[0], x, y)) * 2 - 1;
 	FN_DECIMAL amp = 1;
@@ -920,7 +1010,7 @@ FN_DECIMAL FastNoise::SinglePerlinFractalBillow(FN_DECIMAL x, FN_DECIMAL y)
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SinglePerlinFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SinglePerlinFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	FN_DECIMAL sum = 1 - FastAbs(SinglePerlin(m_perm[0], x, y));
 	FN_DECIMAL amp = 1;
@@ -938,12 +1028,12 @@ FN_DECIMAL FastNoise::SinglePerlinFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y)
 	return sum;
 }
 
-FN_DECIMAL FastNoise::GetPerlin(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::GetPerlin(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	return SinglePerlin(0, x * m_frequency, y * m_frequency);
 }
 
-FN_DECIMAL FastNoise::SinglePerlin(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SinglePerlin(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y) const
 {
 	int x0 = FastFloor(x);
 	int y0 = FastFloor(y);
@@ -980,7 +1070,7 @@ FN_DECIMAL FastNoise::SinglePerlin(unsigned char offset, FN_DECIMAL x, FN_DECIMA
 
 // Simplex Noise
 
-FN_DECIMAL FastNoise::GetSimplexFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::GetSimplexFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	x *= m_frequency;
 	y *= m_frequency;
@@ -999,7 +1089,7 @@ FN_DECIMAL FastNoise::GetSimplexFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z
 	}
 }
 
-FN_DECIMAL FastNoise::SingleSimplexFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SingleSimplexFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	FN_DECIMAL sum = SingleSimplex(m_perm[0], x, y, z);
 	FN_DECIMAL amp = 1;
@@ -1018,7 +1108,7 @@ FN_DECIMAL FastNoise::SingleSimplexFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DEC
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SingleSimplexFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SingleSimplexFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	FN_DECIMAL sum = FastAbs(SingleSimplex(m_perm[0], x, y, z)) * 2 - 1;
 	FN_DECIMAL amp = 1;
@@ -1037,7 +1127,7 @@ FN_DECIMAL FastNoise::SingleSimplexFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SingleSimplexFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SingleSimplexFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	FN_DECIMAL sum = 1 - FastAbs(SingleSimplex(m_perm[0], x, y, z));
 	FN_DECIMAL amp = 1;
@@ -1056,7 +1146,7 @@ FN_DECIMAL FastNoise::SingleSimplexFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y,
 	return sum;
 }
 
-FN_DECIMAL FastNoise::GetSimplex(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::GetSimplex(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	return SingleSimplex(0, x * m_frequency, y * m_frequency, z * m_frequency);
 }
@@ -1064,7 +1154,7 @@ FN_DECIMAL FastNoise::GetSimplex(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
 static const FN_DECIMAL F3 = 1 / FN_DECIMAL(3);
 static const FN_DECIMAL G3 = 1 / FN_DECIMAL(6);
 
-FN_DECIMAL FastNoise::SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	FN_DECIMAL t = (x + y + z) * F3;
 	int i = FastFloor(x + t);
@@ -1161,7 +1251,7 @@ FN_DECIMAL FastNoise::SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIM
 	return 32 * (n0 + n1 + n2 + n3);
 }
 
-FN_DECIMAL FastNoise::GetSimplexFractal(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::GetSimplexFractal(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	x *= m_frequency;
 	y *= m_frequency;
@@ -1179,7 +1269,7 @@ FN_DECIMAL FastNoise::GetSimplexFractal(FN_DECIMAL x, FN_DECIMAL y)
 	}
 }
 
-FN_DECIMAL FastNoise::SingleSimplexFractalFBM(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleSimplexFractalFBM(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	FN_DECIMAL sum = SingleSimplex(m_perm[0], x, y);
 	FN_DECIMAL amp = 1;
@@ -1197,7 +1287,7 @@ FN_DECIMAL FastNoise::SingleSimplexFractalFBM(FN_DECIMAL x, FN_DECIMAL y)
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SingleSimplexFractalBillow(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleSimplexFractalBillow(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	FN_DECIMAL sum = FastAbs(SingleSimplex(m_perm[0], x, y)) * 2 - 1;
 	FN_DECIMAL amp = 1;
@@ -1215,7 +1305,7 @@ FN_DECIMAL FastNoise::SingleSimplexFractalBillow(FN_DECIMAL x, FN_DECIMAL y)
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SingleSimplexFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleSimplexFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	FN_DECIMAL sum = 1 - FastAbs(SingleSimplex(m_perm[0], x, y));
 	FN_DECIMAL amp = 1;
@@ -1233,7 +1323,7 @@ FN_DECIMAL FastNoise::SingleSimplexFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y)
 	return sum;
 }
 
-FN_DECIMAL FastNoise::SingleSimplexFractalBlend(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleSimplexFractalBlend(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	FN_DECIMAL sum = SingleSimplex(m_perm[0], x, y);
 	FN_DECIMAL amp = 1;
@@ -1251,7 +1341,7 @@ FN_DECIMAL FastNoise::SingleSimplexFractalBlend(FN_DECIMAL x, FN_DECIMAL y)
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::GetSimplex(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::GetSimplex(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	return SingleSimplex(0, x * m_frequency, y * m_frequency);
 }
@@ -1263,7 +1353,7 @@ static const FN_DECIMAL SQRT3 = 1.7320508075688772935274463415059;
 static const FN_DECIMAL F2 = 0.5 * (SQRT3 - 1.0);
 static const FN_DECIMAL G2 = (3.0 - SQRT3) / 6.0;
 
-FN_DECIMAL FastNoise::SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y) const
 {
 	FN_DECIMAL t = (x + y) * F2;
 	int i = FastFloor(x + t);
@@ -1320,7 +1410,7 @@ FN_DECIMAL FastNoise::SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIM
 	return 70 * (n0 + n1 + n2);
 }
 
-FN_DECIMAL FastNoise::GetSimplex(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w)
+FN_DECIMAL FastNoise::GetSimplex(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w) const
 {
 	return SingleSimplex(0, x * m_frequency, y * m_frequency, z * m_frequency, w * m_frequency);
 }
@@ -1340,7 +1430,7 @@ static const unsigned char SIMPLEX_4D[] =
 static const FN_DECIMAL F4 = (sqrt(FN_DECIMAL(5)) - 1) / 4;
 static const FN_DECIMAL G4 = (5 - sqrt(FN_DECIMAL(5))) / 2;
 
-FN_DECIMAL FastNoise::SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w)
+FN_DECIMAL FastNoise::SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w) const
 {
 	FN_DECIMAL n0, n1, n2, n3, n4;
 	FN_DECIMAL t = (x + y + z + w) * F4;
@@ -1431,7 +1521,7 @@ FN_DECIMAL FastNoise::SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIM
 }
 
 // Cubic Noise
-FN_DECIMAL FastNoise::GetCubicFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::GetCubicFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	x *= m_frequency;
 	y *= m_frequency;
@@ -1450,7 +1540,7 @@ FN_DECIMAL FastNoise::GetCubicFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
 	}
 }
 
-FN_DECIMAL FastNoise::SingleCubicFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SingleCubicFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	FN_DECIMAL sum = SingleCubic(m_perm[0], x, y, z);
 	FN_DECIMAL amp = 1;
@@ -1469,7 +1559,7 @@ FN_DECIMAL FastNoise::SingleCubicFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIM
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SingleCubicFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SingleCubicFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	FN_DECIMAL sum = FastAbs(SingleCubic(m_perm[0], x, y, z)) * 2 - 1;
 	FN_DECIMAL amp = 1;
@@ -1488,7 +1578,7 @@ FN_DECIMAL FastNoise::SingleCubicFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DE
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SingleCubicFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SingleCubicFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	FN_DECIMAL sum = 1 - FastAbs(SingleCubic(m_perm[0], x, y, z));
 	FN_DECIMAL amp = 1;
@@ -1507,14 +1597,14 @@ FN_DECIMAL FastNoise::SingleCubicFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, F
 	return sum;
 }
 
-FN_DECIMAL FastNoise::GetCubic(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::GetCubic(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	return SingleCubic(0, x * m_frequency, y * m_frequency, z * m_frequency);
 }
 
 const FN_DECIMAL CUBIC_3D_BOUNDING = 1 / (1.5*1.5*1.5);
 
-FN_DECIMAL FastNoise::SingleCubic(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SingleCubic(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	int x1 = FastFloor(x);
 	int y1 = FastFloor(y);
@@ -1563,7 +1653,7 @@ FN_DECIMAL FastNoise::SingleCubic(unsigned char offset, FN_DECIMAL x, FN_DECIMAL
 }
 
 
-FN_DECIMAL FastNoise::GetCubicFractal(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::GetCubicFractal(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	x *= m_frequency;
 	y *= m_frequency;
@@ -1581,7 +1671,7 @@ FN_DECIMAL FastNoise::GetCubicFractal(FN_DECIMAL x, FN_DECIMAL y)
 	}
 }
 
-FN_DECIMAL FastNoise::SingleCubicFractalFBM(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleCubicFractalFBM(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	FN_DECIMAL sum = SingleCubic(m_perm[0], x, y);
 	FN_DECIMAL amp = 1;
@@ -1599,7 +1689,7 @@ FN_DECIMAL FastNoise::SingleCubicFractalFBM(FN_DECIMAL x, FN_DECIMAL y)
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SingleCubicFractalBillow(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleCubicFractalBillow(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	FN_DECIMAL sum = FastAbs(SingleCubic(m_perm[0], x, y)) * 2 - 1;
 	FN_DECIMAL amp = 1;
@@ -1617,7 +1707,7 @@ FN_DECIMAL FastNoise::SingleCubicFractalBillow(FN_DECIMAL x, FN_DECIMAL y)
 	return sum * m_fractalBounding;
 }
 
-FN_DECIMAL FastNoise::SingleCubicFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleCubicFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	FN_DECIMAL sum = 1 - FastAbs(SingleCubic(m_perm[0], x, y));
 	FN_DECIMAL amp = 1;
@@ -1635,7 +1725,7 @@ FN_DECIMAL FastNoise::SingleCubicFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y)
 	return sum;
 }
 
-FN_DECIMAL FastNoise::GetCubic(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::GetCubic(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	x *= m_frequency;
 	y *= m_frequency;
@@ -1645,7 +1735,7 @@ FN_DECIMAL FastNoise::GetCubic(FN_DECIMAL x, FN_DECIMAL y)
 
 const FN_DECIMAL CUBIC_2D_BOUNDING = 1 / (1.5*1.5);
 
-FN_DECIMAL FastNoise::SingleCubic(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleCubic(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y) const
 {
 	int x1 = FastFloor(x);
 	int y1 = FastFloor(y);
@@ -1669,7 +1759,83 @@ FN_DECIMAL FastNoise::SingleCubic(unsigned char offset, FN_DECIMAL x, FN_DECIMAL
 }
 
 // Cellular Noise
-FN_DECIMAL FastNoise::GetCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+// Direct mapped NoiseLookup values by cell for the length of one grid fill. All the samples that
+// are nearest to a cell look up the same point, so at low frequencies a fill only calls GetNoise()
+// about once per cell instead of once per sample.
+struct FastNoiseLookupCache
+{
+	static const int SIZE = 256;
+
+	struct Entry
+	{
+		int x, y, z;
+		bool used;
+		FN_DECIMAL value;
+	};
+	Entry entries[SIZE];
+
+	FastNoiseLookupCache()
+	{
+		for (int i = 0; i < SIZE; i++)
+			entries[i].used = false;
+	}
+
+	Entry& Slot(int x, int y, int z)
+	{
+		unsigned int hash = (unsigned int)x * X_PRIME ^ (unsigned int)y * Y_PRIME ^ (unsigned int)z * Z_PRIME;
+		return entries[hash & (SIZE - 1)];
+	}
+};
+
+FN_DECIMAL FastNoise::CellularLookup(int xc, int yc, int zc, FastNoiseLookupCache* lookupCache) const
+{
+	FastNoiseLookupCache::Entry* entry = 0;
+	if (lookupCache)
+	{
+		entry = &lookupCache->Slot(xc, yc, zc);
+		if (entry->used && entry->x == xc && entry->y == yc && entry->z == zc)
+			return entry->value;
+	}
+
+	unsigned char lutPos = Index3D_256(0, xc, yc, zc);
+	FN_DECIMAL value = m_cellularNoiseLookup->GetNoise(xc + CELL_3D_X[lutPos] * m_cellularJitter, yc + CELL_3D_Y[lutPos] * m_cellularJitter, zc + CELL_3D_Z[lutPos] * m_cellularJitter);
+
+	if (entry)
+	{
+		entry->x = xc;
+		entry->y = yc;
+		entry->z = zc;
+		entry->used = true;
+		entry->value = value;
+	}
+	return value;
+}
+
+FN_DECIMAL FastNoise::CellularLookup(int xc, int yc, FastNoiseLookupCache* lookupCache) const
+{
+	FastNoiseLookupCache::Entry* entry = 0;
+	if (lookupCache)
+	{
+		entry = &lookupCache->Slot(xc, yc, 0);
+		if (entry->used && entry->x == xc && entry->y == yc)
+			return entry->value;
+	}
+
+	unsigned char lutPos = Index2D_256(0, xc, yc);
+	FN_DECIMAL value = m_cellularNoiseLookup->GetNoise(xc + CELL_2D_X[lutPos] * m_cellularJitter, yc + CELL_2D_Y[lutPos] * m_cellularJitter);
+
+	if (entry)
+	{
+		entry->x = xc;
+		entry->y = yc;
+		entry->z = 0;
+		entry->used = true;
+		entry->value = value;
+	}
+	return value;
+}
+
+FN_DECIMAL FastNoise::GetCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	x *= m_frequency;
 	y *= m_frequency;
@@ -1686,7 +1852,7 @@ FN_DECIMAL FastNoise::GetCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
 	}
 }
 
-FN_DECIMAL FastNoise::SingleCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SingleCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FastNoiseLookupCache* lookupCache) const
 {
 	int xr = FastRound(x);
 	int yr = FastRound(y);
@@ -1779,7 +1945,6 @@ FN_DECIMAL FastNoise::SingleCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
 		break;
 	}
 
-	unsigned char lutPos;
 	switch (m_cellularReturnType)
 	{
 	case CellValue:
@@ -1788,8 +1953,7 @@ FN_DECIMAL FastNoise::SingleCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
 	case NoiseLookup:
 		assert(m_cellularNoiseLookup);
 
-		lutPos = Index3D_256(0, xc, yc, zc);
-		return m_cellularNoiseLookup->GetNoise(xc + CELL_3D_X[lutPos] * m_cellularJitter, yc + CELL_3D_Y[lutPos] * m_cellularJitter, zc + CELL_3D_Z[lutPos] * m_cellularJitter);
+		return CellularLookup(xc, yc, zc, lookupCache);
 
 	case Distance:
 		return distance;
@@ -1798,7 +1962,7 @@ FN_DECIMAL FastNoise::SingleCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
 	}
 }
 
-FN_DECIMAL FastNoise::SingleCellular2Edge(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z)
+FN_DECIMAL FastNoise::SingleCellular2Edge(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const
 {
 	int xr = FastRound(x);
 	int yr = FastRound(y);
@@ -1895,7 +2059,7 @@ FN_DECIMAL FastNoise::SingleCellular2Edge(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL
 	}
 }
 
-FN_DECIMAL FastNoise::GetCellular(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::GetCellular(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	x *= m_frequency;
 	y *= m_frequency;
@@ -1911,7 +2075,7 @@ FN_DECIMAL FastNoise::GetCellular(FN_DECIMAL x, FN_DECIMAL y)
 	}
 }
 
-FN_DECIMAL FastNoise::SingleCellular(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleCellular(FN_DECIMAL x, FN_DECIMAL y, FastNoiseLookupCache* lookupCache) const
 {
 	int xr = FastRound(x);
 	int yr = FastRound(y);
@@ -1987,7 +2151,6 @@ FN_DECIMAL FastNoise::SingleCellular(FN_DECIMAL x, FN_DECIMAL y)
 		break;
 	}
 
-	unsigned char lutPos;
 	switch (m_cellularReturnType)
 	{
 	case CellValue:
@@ -1996,8 +2159,7 @@ FN_DECIMAL FastNoise::SingleCellular(FN_DECIMAL x, FN_DECIMAL y)
 	case NoiseLookup:
 		assert(m_cellularNoiseLookup);
 
-		lutPos = Index2D_256(0, xc, yc);
-		return m_cellularNoiseLookup->GetNoise(xc + CELL_2D_X[lutPos] * m_cellularJitter, yc + CELL_2D_Y[lutPos] * m_cellularJitter);
+		return CellularLookup(xc, yc, lookupCache);
 
 	case Distance:
 		return distance;
@@ -2006,7 +2168,7 @@ FN_DECIMAL FastNoise::SingleCellular(FN_DECIMAL x, FN_DECIMAL y)
 	}
 }
 
-FN_DECIMAL FastNoise::SingleCellular2Edge(FN_DECIMAL x, FN_DECIMAL y)
+FN_DECIMAL FastNoise::SingleCellular2Edge(FN_DECIMAL x, FN_DECIMAL y) const
 {
 	int xr = FastRound(x);
 	int yr = FastRound(y);
@@ -2089,12 +2251,12 @@ FN_DECIMAL FastNoise::SingleCellular2Edge(FN_DECIMAL x, FN_DECIMAL y)
 	}
 }
 
-void FastNoise::GradientPerturb(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z)
+void FastNoise::GradientPerturb(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z) const
 {
 	SingleGradientPerturb(0, m_gradientPerturbAmp, m_frequency, x, y, z);
 }
 
-void FastNoise::GradientPerturbFractal(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z)
+void FastNoise::GradientPerturbFractal(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z) const
 {
 	FN_DECIMAL amp = m_gradientPerturbAmp * m_fractalBounding;
 	FN_DECIMAL freq = m_frequency;
@@ -2110,7 +2272,7 @@ void FastNoise::GradientPerturbFractal(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL&
 	}
 }
 
-void FastNoise::SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp, FN_DECIMAL frequency, FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z)
+void FastNoise::SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp, FN_DECIMAL frequency, FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z) const
 {
 	FN_DECIMAL xf = x * frequency;
 	FN_DECIMAL yf = y * frequency;
@@ -2181,12 +2343,12 @@ void FastNoise::SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp,
 	z += Lerp(lz0y, Lerp(lz0x, lz1x, ys), zs) * warpAmp;
 }
 
-void FastNoise::GradientPerturb(FN_DECIMAL& x, FN_DECIMAL& y)
+void FastNoise::GradientPerturb(FN_DECIMAL& x, FN_DECIMAL& y) const
 {
 	SingleGradientPerturb(0, m_gradientPerturbAmp, m_frequency, x, y);
 }
 
-void FastNoise::GradientPerturbFractal(FN_DECIMAL& x, FN_DECIMAL& y)
+void FastNoise::GradientPerturbFractal(FN_DECIMAL& x, FN_DECIMAL& y) const
 {
 	FN_DECIMAL amp = m_gradientPerturbAmp * m_fractalBounding;
 	FN_DECIMAL freq = m_frequency;
@@ -2202,7 +2364,7 @@ void FastNoise::GradientPerturbFractal(FN_DECIMAL& x, FN_DECIMAL& y)
 	}
 }
 
-void FastNoise::SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp, FN_DECIMAL frequency, FN_DECIMAL& x, FN_DECIMAL& y)
+void FastNoise::SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp, FN_DECIMAL frequency, FN_DECIMAL& x, FN_DECIMAL& y) const
 {
 	FN_DECIMAL xf = x * frequency;
 	FN_DECIMAL yf = y * frequency;
@@ -2245,3 +2407,1329 @@ void FastNoise::SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp,
 	x += Lerp(lx0x, lx1x, ys) * warpAmp;
 	y += Lerp(ly0x, ly1x, ys) * warpAmp;
 }
+
+// Derivatives
+FN_DECIMAL FastNoise::GetValueDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const
+{
+	FN_DECIMAL value = SingleValueDeriv(0, x * m_frequency, y * m_frequency, dx, dy);
+	dx *= m_frequency;
+	dy *= m_frequency;
+	return value;
+}
+
+FN_DECIMAL FastNoise::GetValueFractalDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const
+{
+	FN_DECIMAL value = SingleFractalDeriv(&FastNoise::SingleValueDeriv, x * m_frequency, y * m_frequency, dx, dy);
+	dx *= m_frequency;
+	dy *= m_frequency;
+	return value;
+}
+
+FN_DECIMAL FastNoise::GetPerlinDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const
+{
+	FN_DECIMAL value = SinglePerlinDeriv(0, x * m_frequency, y * m_frequency, dx, dy);
+	dx *= m_frequency;
+	dy *= m_frequency;
+	return value;
+}
+
+FN_DECIMAL FastNoise::GetPerlinFractalDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const
+{
+	FN_DECIMAL value = SingleFractalDeriv(&FastNoise::SinglePerlinDeriv, x * m_frequency, y * m_frequency, dx, dy);
+	dx *= m_frequency;
+	dy *= m_frequency;
+	return value;
+}
+
+FN_DECIMAL FastNoise::GetSimplexDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const
+{
+	FN_DECIMAL value = SingleSimplexDeriv(0, x * m_frequency, y * m_frequency, dx, dy);
+	dx *= m_frequency;
+	dy *= m_frequency;
+	return value;
+}
+
+FN_DECIMAL FastNoise::GetSimplexFractalDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const
+{
+	FN_DECIMAL value = SingleFractalDeriv(&FastNoise::SingleSimplexDeriv, x * m_frequency, y * m_frequency, dx, dy);
+	dx *= m_frequency;
+	dy *= m_frequency;
+	return value;
+}
+
+// Same octaves as Single*FractalFBM/Billow/RigidMulti(), each octave's derivative is scaled by its
+// amplitude and by the lacunarity it was sampled at. Billow and RigidMulti fold the noise with an
+// abs(), so their derivative flips sign with the noise.
+FN_DECIMAL FastNoise::SingleFractalDeriv(DerivKernel kernel, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const
+{
+	FN_DECIMAL ndx, ndy;
+	FN_DECIMAL n = (this->*kernel)(m_perm[0], x, y, ndx, ndy);
+	FN_DECIMAL sum, sign;
+	FN_DECIMAL amp = 1;
+	FN_DECIMAL scale = 1;
+	int i = 0;
+
+	switch (m_fractalType)
+	{
+	case FBM:
+		sum = n;
+		dx = ndx;
+		dy = ndy;
+
+		while (++i < m_octaves)
+		{
+			x *= m_lacunarity;
+			y *= m_lacunarity;
+			scale *= m_lacunarity;
+
+			amp *= m_gain;
+			n = (this->*kernel)(m_perm[i], x, y, ndx, ndy);
+			sum += n * amp;
+			dx += ndx * amp * scale;
+			dy += ndy * amp * scale;
+		}
+
+		dx *= m_fractalBounding;
+		dy *= m_fractalBounding;
+		return sum * m_fractalBounding;
+	case Billow:
+		sum = FastAbs(n) * 2 - 1;
+		sign = n < 0 ? -2 : 2;
+		dx = ndx * sign;
+		dy = ndy * sign;
+
+		while (++i < m_octaves)
+		{
+			x *= m_lacunarity;
+			y *= m_lacunarity;
+			scale *= m_lacunarity;
+			amp *= m_gain;
+			n = (this->*kernel)(m_perm[i], x, y, ndx, ndy);
+			sum += (FastAbs(n) * 2 - 1) * amp;
+			sign = n < 0 ? -2 : 2;
+			dx += ndx * sign * amp * scale;
+			dy += ndy * sign * amp * scale;
+		}
+
+		dx *= m_fractalBounding;
+		dy *= m_fractalBounding;
+		return sum * m_fractalBounding;
+	case RigidMulti:
+		sum = 1 - FastAbs(n);
+		sign = n < 0 ? 1 : -1;
+		dx = ndx * sign;
+		dy = ndy * sign;
+
+		while (++i < m_octaves)
+		{
+			x *= m_lacunarity;
+			y *= m_lacunarity;
+			scale *= m_lacunarity;
+
+			amp *= m_gain;
+			n = (this->*kernel)(m_perm[i], x, y, ndx, ndy);
+			sum -= (1 - FastAbs(n)) * amp;
+			sign = n < 0 ? 1 : -1;
+			dx -= ndx * sign * amp * scale;
+			dy -= ndy * sign * amp * scale;
+		}
+
+		return sum;
+	default:
+		dx = 0;
+		dy = 0;
+		return 0;
+	}
+}
+
+FN_DECIMAL FastNoise::SingleValueDeriv(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const
+{
+	int x0 = FastFloor(x);
+	int y0 = FastFloor(y);
+	int x1 = x0 + 1;
+	int y1 = y0 + 1;
+
+	FN_DECIMAL xs, ys, dxs, dys;
+	switch (m_interp)
+	{
+	case Linear:
+		xs = x - (FN_DECIMAL)x0;
+		ys = y - (FN_DECIMAL)y0;
+		dxs = dys = 1;
+		break;
+	case Hermite:
+		xs = InterpHermiteFunc(x - (FN_DECIMAL)x0);
+		ys = InterpHermiteFunc(y - (FN_DECIMAL)y0);
+		dxs = InterpHermiteFuncDeriv(x - (FN_DECIMAL)x0);
+		dys = InterpHermiteFuncDeriv(y - (FN_DECIMAL)y0);
+		break;
+	case Quintic:
+	default:
+		xs = InterpQuinticFunc(x - (FN_DECIMAL)x0);
+		ys = InterpQuinticFunc(y - (FN_DECIMAL)y0);
+		dxs = InterpQuinticFuncDeriv(x - (FN_DECIMAL)x0);
+		dys = InterpQuinticFuncDeriv(y - (FN_DECIMAL)y0);
+		break;
+	}
+
+	FN_DECIMAL v00 = ValCoord2DFast(offset, x0, y0);
+	FN_DECIMAL v10 = ValCoord2DFast(offset, x1, y0);
+	FN_DECIMAL v01 = ValCoord2DFast(offset, x0, y1);
+	FN_DECIMAL v11 = ValCoord2DFast(offset, x1, y1);
+
+	FN_DECIMAL xf0 = Lerp(v00, v10, xs);
+	FN_DECIMAL xf1 = Lerp(v01, v11, xs);
+
+	dx = Lerp(v10 - v00, v11 - v01, ys) * dxs;
+	dy = (xf1 - xf0) * dys;
+	return Lerp(xf0, xf1, ys);
+}
+
+FN_DECIMAL FastNoise::SinglePerlinDeriv(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const
+{
+	int x0 = FastFloor(x);
+	int y0 = FastFloor(y);
+	int x1 = x0 + 1;
+	int y1 = y0 + 1;
+
+	FN_DECIMAL xd0 = x - (FN_DECIMAL)x0;
+	FN_DECIMAL yd0 = y - (FN_DECIMAL)y0;
+	FN_DECIMAL xd1 = xd0 - 1;
+	FN_DECIMAL yd1 = yd0 - 1;
+
+	FN_DECIMAL xs, ys, dxs, dys;
+	switch (m_interp)
+	{
+	case Linear:
+		xs = xd0;
+		ys = yd0;
+		dxs = dys = 1;
+		break;
+	case Hermite:
+		xs = InterpHermiteFunc(xd0);
+		ys = InterpHermiteFunc(yd0);
+		dxs = InterpHermiteFuncDeriv(xd0);
+		dys = InterpHermiteFuncDeriv(yd0);
+		break;
+	case Quintic:
+	default:
+		xs = InterpQuinticFunc(xd0);
+		ys = InterpQuinticFunc(yd0);
+		dxs = InterpQuinticFuncDeriv(xd0);
+		dys = InterpQuinticFuncDeriv(yd0);
+		break;
+	}
+
+	unsigned char lut00 = Index2D_12(offset, x0, y0);
+	unsigned char lut10 = Index2D_12(offset, x1, y0);
+	unsigned char lut01 = Index2D_12(offset, x0, y1);
+	unsigned char lut11 = Index2D_12(offset, x1, y1);
+
+	FN_DECIMAL g00 = xd0*GRAD_X[lut00] + yd0*GRAD_Y[lut00];
+	FN_DECIMAL g10 = xd1*GRAD_X[lut10] + yd0*GRAD_Y[lut10];
+	FN_DECIMAL g01 = xd0*GRAD_X[lut01] + yd1*GRAD_Y[lut01];
+	FN_DECIMAL g11 = xd1*GRAD_X[lut11] + yd1*GRAD_Y[lut11];
+
+	FN_DECIMAL xf0 = Lerp(g00, g10, xs);
+	FN_DECIMAL xf1 = Lerp(g01, g11, xs);
+
+	// A corner's dot product changes along its gradient, the blend along the interpolant's slope
+	FN_DECIMAL xf0dx = Lerp(GRAD_X[lut00], GRAD_X[lut10], xs) + (g10 - g00) * dxs;
+	FN_DECIMAL xf1dx = Lerp(GRAD_X[lut01], GRAD_X[lut11], xs) + (g11 - g01) * dxs;
+	FN_DECIMAL xf0dy = Lerp(GRAD_Y[lut00], GRAD_Y[lut10], xs);
+	FN_DECIMAL xf1dy = Lerp(GRAD_Y[lut01], GRAD_Y[lut11], xs);
+
+	dx = Lerp(xf0dx, xf1dx, ys);
+	dy = Lerp(xf0dy, xf1dy, ys) + (xf1 - xf0) * dys;
+	return Lerp(xf0, xf1, ys);
+}
+
+// One corner of SingleSimplexDeriv(): t^4 * (gradient . d), and its derivative
+// t^4 * gradient - 8 * t^3 * (gradient . d) * d added to dx, dy
+static FN_DECIMAL SimplexCornerDeriv(unsigned char lutPos, FN_DECIMAL xd, FN_DECIMAL yd, FN_DECIMAL& dx, FN_DECIMAL& dy)
+{
+	FN_DECIMAL t = FN_DECIMAL(0.5) - xd*xd - yd*yd;
+	if (t < 0)
+		return 0;
+
+	FN_DECIMAL g = xd*GRAD_X[lutPos] + yd*GRAD_Y[lutPos];
+	FN_DECIMAL t2 = t * t;
+	FN_DECIMAL t3g8 = 8 * t2 * t * g;
+
+	dx += t2 * t2 * GRAD_X[lutPos] - t3g8 * xd;
+	dy += t2 * t2 * GRAD_Y[lutPos] - t3g8 * yd;
+	return t2 * t2 * g;
+}
+
+FN_DECIMAL FastNoise::SingleSimplexDeriv(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const
+{
+	FN_DECIMAL t = (x + y) * F2;
+	int i = FastFloor(x + t);
+	int j = FastFloor(y + t);
+
+	t = (i + j) * G2;
+	FN_DECIMAL X0 = i - t;
+	FN_DECIMAL Y0 = j - t;
+
+	FN_DECIMAL x0 = x - X0;
+	FN_DECIMAL y0 = y - Y0;
+
+	int i1, j1;
+	if (x0 > y0)
+	{
+		i1 = 1; j1 = 0;
+	}
+	else
+	{
+		i1 = 0; j1 = 1;
+	}
+
+	FN_DECIMAL x1 = x0 - (FN_DECIMAL)i1 + G2;
+	FN_DECIMAL y1 = y0 - (FN_DECIMAL)j1 + G2;
+	FN_DECIMAL x2 = x0 - 1 + 2*G2;
+	FN_DECIMAL y2 = y0 - 1 + 2*G2;
+
+	dx = 0;
+	dy = 0;
+	FN_DECIMAL n0 = SimplexCornerDeriv(Index2D_12(offset, i, j), x0, y0, dx, dy);
+	FN_DECIMAL n1 = SimplexCornerDeriv(Index2D_12(offset, i + i1, j + j1), x1, y1, dx, dy);
+	FN_DECIMAL n2 = SimplexCornerDeriv(Index2D_12(offset, i + 1, j + 1), x2, y2, dx, dy);
+
+	dx *= 70;
+	dy *= 70;
+	return 70 * (n0 + n1 + n2);
+}
+
+// Grid Fill
+#define FN_FILL_GRID_2D(single) \
+	for (int j = 0; j < height; j++) \
+	{ \
+		FN_DECIMAL yf = ((FN_DECIMAL)y0 + (FN_DECIMAL)j * step) * m_frequency; \
+		for (int i = 0; i < width; i++) \
+		{ \
+			FN_DECIMAL xf = ((FN_DECIMAL)x0 + (FN_DECIMAL)i * step) * m_frequency; \
+			*noiseOut++ = single; \
+		} \
+	}
+
+#define FN_FILL_GRID_3D(single) \
+	for (int k = 0; k < depth; k++) \
+	{ \
+		FN_DECIMAL zf = ((FN_DECIMAL)z0 + (FN_DECIMAL)k * step) * m_frequency; \
+		for (int j = 0; j < height; j++) \
+		{ \
+			FN_DECIMAL yf = ((FN_DECIMAL)y0 + (FN_DECIMAL)j * step) * m_frequency; \
+			for (int i = 0; i < width; i++) \
+			{ \
+				FN_DECIMAL xf = ((FN_DECIMAL)x0 + (FN_DECIMAL)i * step) * m_frequency; \
+				*noiseOut++ = single; \
+			} \
+		} \
+	}
+
+void FastNoise::FillGrid2D(FN_DECIMAL* noiseOut, int x0, int y0, int width, int height, FN_DECIMAL step) const
+{
+	if (FillGrid2DSIMD(noiseOut, x0, y0, width, height, step))
+		return;
+
+	switch (m_noiseType)
+	{
+	case Value:
+		FN_FILL_GRID_2D(SingleValue(0, xf, yf));
+		break;
+	case ValueFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FN_FILL_GRID_2D(SingleValueFractalFBM(xf, yf));
+			break;
+		case Billow:
+			FN_FILL_GRID_2D(SingleValueFractalBillow(xf, yf));
+			break;
+		case RigidMulti:
+			FN_FILL_GRID_2D(SingleValueFractalRigidMulti(xf, yf));
+			break;
+		}
+		break;
+	case Perlin:
+		FN_FILL_GRID_2D(SinglePerlin(0, xf, yf));
+		break;
+	case PerlinFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FN_FILL_GRID_2D(SinglePerlinFractalFBM(xf, yf));
+			break;
+		case Billow:
+			FN_FILL_GRID_2D(SinglePerlinFractalBillow(xf, yf));
+			break;
+		case RigidMulti:
+			FN_FILL_GRID_2D(SinglePerlinFractalRigidMulti(xf, yf));
+			break;
+		}
+		break;
+	case Simplex:
+		FN_FILL_GRID_2D(SingleSimplex(0, xf, yf));
+		break;
+	case SimplexFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FN_FILL_GRID_2D(SingleSimplexFractalFBM(xf, yf));
+			break;
+		case Billow:
+			FN_FILL_GRID_2D(SingleSimplexFractalBillow(xf, yf));
+			break;
+		case RigidMulti:
+			FN_FILL_GRID_2D(SingleSimplexFractalRigidMulti(xf, yf));
+			break;
+		}
+		break;
+	case Cellular:
+		switch (m_cellularReturnType)
+		{
+		case CellValue:
+		case Distance:
+			FN_FILL_GRID_2D(SingleCellular(xf, yf));
+			break;
+		case NoiseLookup:
+		{
+			FastNoiseLookupCache lookupCache;
+			FN_FILL_GRID_2D(SingleCellular(xf, yf, &lookupCache));
+			break;
+		}
+		default:
+			FN_FILL_GRID_2D(SingleCellular2Edge(xf, yf));
+			break;
+		}
+		break;
+	case WhiteNoise:
+		FN_FILL_GRID_2D(GetWhiteNoise(xf, yf));
+		break;
+	case Cubic:
+		FN_FILL_GRID_2D(SingleCubic(0, xf, yf));
+		break;
+	case CubicFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FN_FILL_GRID_2D(SingleCubicFractalFBM(xf, yf));
+			break;
+		case Billow:
+			FN_FILL_GRID_2D(SingleCubicFractalBillow(xf, yf));
+			break;
+		case RigidMulti:
+			FN_FILL_GRID_2D(SingleCubicFractalRigidMulti(xf, yf));
+			break;
+		}
+		break;
+	}
+}
+
+void FastNoise::FillGrid3D(FN_DECIMAL* noiseOut, int x0, int y0, int z0, int width, int height, int depth, FN_DECIMAL step) const
+{
+	if (FillGrid3DSIMD(noiseOut, x0, y0, z0, width, height, depth, step))
+		return;
+
+	switch (m_noiseType)
+	{
+	case Value:
+		FN_FILL_GRID_3D(SingleValue(0, xf, yf, zf));
+		break;
+	case ValueFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FN_FILL_GRID_3D(SingleValueFractalFBM(xf, yf, zf));
+			break;
+		case Billow:
+			FN_FILL_GRID_3D(SingleValueFractalBillow(xf, yf, zf));
+			break;
+		case RigidMulti:
+			FN_FILL_GRID_3D(SingleValueFractalRigidMulti(xf, yf, zf));
+			break;
+		}
+		break;
+	case Perlin:
+		FN_FILL_GRID_3D(SinglePerlin(0, xf, yf, zf));
+		break;
+	case PerlinFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FN_FILL_GRID_3D(SinglePerlinFractalFBM(xf, yf, zf));
+			break;
+		case Billow:
+			FN_FILL_GRID_3D(SinglePerlinFractalBillow(xf, yf, zf));
+			break;
+		case RigidMulti:
+			FN_FILL_GRID_3D(SinglePerlinFractalRigidMulti(xf, yf, zf));
+			break;
+		}
+		break;
+	case Simplex:
+		FN_FILL_GRID_3D(SingleSimplex(0, xf, yf, zf));
+		break;
+	case SimplexFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FN_FILL_GRID_3D(SingleSimplexFractalFBM(xf, yf, zf));
+			break;
+		case Billow:
+			FN_FILL_GRID_3D(SingleSimplexFractalBillow(xf, yf, zf));
+			break;
+		case RigidMulti:
+			FN_FILL_GRID_3D(SingleSimplexFractalRigidMulti(xf, yf, zf));
+			break;
+		}
+		break;
+	case Cellular:
+		switch (m_cellularReturnType)
+		{
+		case CellValue:
+		case Distance:
+			FN_FILL_GRID_3D(SingleCellular(xf, yf, zf));
+			break;
+		case NoiseLookup:
+		{
+			FastNoiseLookupCache lookupCache;
+			FN_FILL_GRID_3D(SingleCellular(xf, yf, zf, &lookupCache));
+			break;
+		}
+		default:
+			FN_FILL_GRID_3D(SingleCellular2Edge(xf, yf, zf));
+			break;
+		}
+		break;
+	case WhiteNoise:
+		FN_FILL_GRID_3D(GetWhiteNoise(xf, yf, zf));
+		break;
+	case Cubic:
+		FN_FILL_GRID_3D(SingleCubic(0, xf, yf, zf));
+		break;
+	case CubicFractal:
+		switch (m_fractalType)
+		{
+		case FBM:
+			FN_FILL_GRID_3D(SingleCubicFractalFBM(xf, yf, zf));
+			break;
+		case Billow:
+			FN_FILL_GRID_3D(SingleCubicFractalBillow(xf, yf, zf));
+			break;
+		case RigidMulti:
+			FN_FILL_GRID_3D(SingleCubicFractalRigidMulti(xf, yf, zf));
+			break;
+		}
+		break;
+	}
+}
+
+#if defined(FN_SIMD_SSE2) || defined(FN_SIMD_NEON)
+#define FN_SIMD_LANES 4
+
+#if defined(_MSC_VER)
+#define FN_NOINLINE __declspec(noinline)
+#else
+#define FN_NOINLINE __attribute__((noinline))
+#endif
+
+#if defined(FN_SIMD_SSE2)
+typedef __m128 SIMDf;
+typedef __m128i SIMDi;
+
+static inline SIMDf SIMDf_SET(float a) { return _mm_set1_ps(a); }
+static inline SIMDf SIMDf_LOAD(const float* p) { return _mm_loadu_ps(p); }
+static inline void SIMDf_STORE(float* p, SIMDf a) { _mm_storeu_ps(p, a); }
+static inline SIMDf SIMDf_ADD(SIMDf a, SIMDf b) { return _mm_add_ps(a, b); }
+static inline SIMDf SIMDf_SUB(SIMDf a, SIMDf b) { return _mm_sub_ps(a, b); }
+static inline SIMDf SIMDf_MUL(SIMDf a, SIMDf b) { return _mm_mul_ps(a, b); }
+static inline SIMDf SIMDf_ABS(SIMDf a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+static inline SIMDf SIMDf_LESS_THAN(SIMDf a, SIMDf b) { return _mm_cmplt_ps(a, b); }
+static inline SIMDf SIMDf_BLENDV(SIMDf a, SIMDf b, SIMDf mask) { return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a)); }
+static inline SIMDf SIMDf_MIN(SIMDf a, SIMDf b) { return _mm_min_ps(a, b); }
+static inline SIMDf SIMDf_MAX(SIMDf a, SIMDf b) { return _mm_max_ps(a, b); }
+static inline SIMDf SIMDf_DIV(SIMDf a, SIMDf b) { return _mm_div_ps(a, b); }
+static inline bool SIMDf_ANY(SIMDf mask) { return _mm_movemask_ps(mask) != 0; }
+static inline SIMDf SIMDf_CONVERT_TO_FLOAT(SIMDi a) { return _mm_cvtepi32_ps(a); }
+static inline SIMDi SIMDi_ADD(SIMDi a, SIMDi b) { return _mm_add_epi32(a, b); }
+static inline void SIMDi_STORE(int* p, SIMDi a) { _mm_storeu_si128(reinterpret_cast<SIMDi*>(p), a); }
+static inline SIMDi SIMDi_SET(int a) { return _mm_set1_epi32(a); }
+static inline SIMDi SIMDi_LOAD(const int* p) { return _mm_loadu_si128(reinterpret_cast<const SIMDi*>(p)); }
+static inline SIMDi SIMDi_XOR(SIMDi a, SIMDi b) { return _mm_xor_si128(a, b); }
+template <int Bits> static inline SIMDi SIMDi_SHIFT_R(SIMDi a) { return _mm_srli_epi32(a, Bits); }
+#if defined(__SSE4_1__)
+static inline SIMDi SIMDi_MUL(SIMDi a, SIMDi b) { return _mm_mullo_epi32(a, b); }
+#else
+// SSE2 has no 32 bit multiply, do the even and odd lanes as 64 bit products and keep the low halves
+static inline SIMDi SIMDi_MUL(SIMDi a, SIMDi b)
+{
+	SIMDi even = _mm_mul_epu32(a, b);
+	SIMDi odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+#endif
+// Matches FastFloor(), truncate then step down for anything below zero
+static inline SIMDi SIMDi_FLOOR(SIMDf a) { return _mm_add_epi32(_mm_cvttps_epi32(a), _mm_castps_si128(_mm_cmplt_ps(a, _mm_setzero_ps()))); }
+#else
+typedef float32x4_t SIMDf;
+typedef int32x4_t SIMDi;
+
+static inline SIMDf SIMDf_SET(float a) { return vdupq_n_f32(a); }
+static inline SIMDf SIMDf_LOAD(const float* p) { return vld1q_f32(p); }
+static inline void SIMDf_STORE(float* p, SIMDf a) { vst1q_f32(p, a); }
+static inline SIMDf SIMDf_ADD(SIMDf a, SIMDf b) { return vaddq_f32(a, b); }
+static inline SIMDf SIMDf_SUB(SIMDf a, SIMDf b) { return vsubq_f32(a, b); }
+static inline SIMDf SIMDf_MUL(SIMDf a, SIMDf b) { return vmulq_f32(a, b); }
+static inline SIMDf SIMDf_ABS(SIMDf a) { return vabsq_f32(a); }
+static inline SIMDf SIMDf_LESS_THAN(SIMDf a, SIMDf b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+static inline SIMDf SIMDf_BLENDV(SIMDf a, SIMDf b, SIMDf mask) { return vbslq_f32(vreinterpretq_u32_f32(mask), b, a); }
+static inline SIMDf SIMDf_MIN(SIMDf a, SIMDf b) { return vminq_f32(a, b); }
+static inline SIMDf SIMDf_MAX(SIMDf a, SIMDf b) { return vmaxq_f32(a, b); }
+#if defined(__aarch64__)
+static inline SIMDf SIMDf_DIV(SIMDf a, SIMDf b) { return vdivq_f32(a, b); }
+#else
+// ARMv7 only has a reciprocal estimate, divide per lane to stay exact
+static inline SIMDf SIMDf_DIV(SIMDf a, SIMDf b)
+{
+	float x[FN_SIMD_LANES], y[FN_SIMD_LANES];
+	vst1q_f32(x, a);
+	vst1q_f32(y, b);
+	for (int l = 0; l < FN_SIMD_LANES; l++)
+		x[l] /= y[l];
+	return vld1q_f32(x);
+}
+#endif
+static inline bool SIMDf_ANY(SIMDf mask)
+{
+	uint32x4_t bits = vreinterpretq_u32_f32(mask);
+	uint32x2_t half = vorr_u32(vget_low_u32(bits), vget_high_u32(bits));
+	return (vget_lane_u32(half, 0) | vget_lane_u32(half, 1)) != 0;
+}
+static inline SIMDf SIMDf_CONVERT_TO_FLOAT(SIMDi a) { return vcvtq_f32_s32(a); }
+static inline SIMDi SIMDi_ADD(SIMDi a, SIMDi b) { return vaddq_s32(a, b); }
+static inline void SIMDi_STORE(int* p, SIMDi a) { vst1q_s32(p, a); }
+static inline SIMDi SIMDi_SET(int a) { return vdupq_n_s32(a); }
+static inline SIMDi SIMDi_LOAD(const int* p) { return vld1q_s32(p); }
+static inline SIMDi SIMDi_XOR(SIMDi a, SIMDi b) { return veorq_s32(a, b); }
+template <int Bits> static inline SIMDi SIMDi_SHIFT_R(SIMDi a) { return vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a), Bits)); }
+static inline SIMDi SIMDi_MUL(SIMDi a, SIMDi b) { return vmulq_s32(a, b); }
+// Matches FastFloor(), truncate then step down for anything below zero
+static inline SIMDi SIMDi_FLOOR(SIMDf a) { return vaddq_s32(vcvtq_s32_f32(a), vreinterpretq_s32_u32(vcltq_f32(a, vdupq_n_f32(0)))); }
+#endif
+
+static inline SIMDf SIMDf_LERP(SIMDf a, SIMDf b, SIMDf t) { return SIMDf_ADD(a, SIMDf_MUL(t, SIMDf_SUB(b, a))); }
+
+template <FastNoise::Interp I>
+static inline SIMDf SIMDf_INTERP(SIMDf t)
+{
+	switch (I)
+	{
+	case FastNoise::Hermite:
+		return SIMDf_MUL(SIMDf_MUL(t, t), SIMDf_SUB(SIMDf_SET(3), SIMDf_MUL(SIMDf_SET(2), t)));
+	case FastNoise::Quintic:
+		return SIMDf_MUL(SIMDf_MUL(SIMDf_MUL(t, t), t),
+			SIMDf_ADD(SIMDf_MUL(t, SIMDf_SUB(SIMDf_MUL(t, SIMDf_SET(6)), SIMDf_SET(15))), SIMDf_SET(10)));
+	default:
+		return t;
+	}
+}
+
+static inline SIMDf SIMDf_CUBIC_LERP(SIMDf a, SIMDf b, SIMDf c, SIMDf d, SIMDf t)
+{
+	SIMDf p = SIMDf_SUB(SIMDf_SUB(d, c), SIMDf_SUB(a, b));
+	SIMDf t2 = SIMDf_MUL(t, t);
+	return SIMDf_ADD(SIMDf_ADD(SIMDf_ADD(SIMDf_MUL(SIMDf_MUL(t2, t), p), SIMDf_MUL(t2, SIMDf_SUB(SIMDf_SUB(a, b), p))), SIMDf_MUL(t, SIMDf_SUB(c, a))), b);
+}
+
+// The permutation table lookups are done per lane, everything else runs across all lanes
+struct FastNoiseGrid
+{
+	typedef SIMDf(*Kernel2D)(const FastNoise& noise, unsigned char offset, SIMDf x, SIMDf y);
+
+	// HashCoord() of all lanes at once
+	static SIMDi Hash2D(const FastNoise& noise, unsigned char offset, SIMDi x, SIMDi y)
+	{
+		SIMDi n = SIMDi_SET((int)HashSeed(noise.m_seed, offset));
+		n = SIMDi_XOR(n, SIMDi_XOR(SIMDi_MUL(x, SIMDi_SET(X_PRIME)), SIMDi_MUL(y, SIMDi_SET(Y_PRIME))));
+
+		n = SIMDi_XOR(n, SIMDi_SHIFT_R<15>(n));
+		n = SIMDi_MUL(n, SIMDi_SET((int)0x2c1b3c6du));
+		n = SIMDi_XOR(n, SIMDi_SHIFT_R<12>(n));
+		n = SIMDi_MUL(n, SIMDi_SET((int)0x297a2d39u));
+		return SIMDi_XOR(n, SIMDi_SHIFT_R<15>(n));
+	}
+
+	// Index2D_12() (twelve) or Index2D_256() of each lane. The integer hash does all lanes
+	// together, the permutation table has to be walked one lane at a time.
+	static void Index2D(const FastNoise& noise, unsigned char offset, SIMDi x, SIMDi y, bool twelve, unsigned char* lutPos)
+	{
+		if (noise.m_hashType == FastNoise::IntegerHash)
+		{
+			unsigned int hash[FN_SIMD_LANES];
+			SIMDi_STORE(reinterpret_cast<int*>(hash), Hash2D(noise, offset, x, y));
+			for (int l = 0; l < FN_SIMD_LANES; l++)
+				lutPos[l] = twelve ? HashTo12(hash[l]) : HashTo256(hash[l]);
+		}
+		else
+		{
+			int xi[FN_SIMD_LANES], yi[FN_SIMD_LANES];
+			SIMDi_STORE(xi, x);
+			SIMDi_STORE(yi, y);
+			for (int l = 0; l < FN_SIMD_LANES; l++)
+				lutPos[l] = twelve ? noise.Index2D_12(offset, xi[l], yi[l]) : noise.Index2D_256(offset, xi[l], yi[l]);
+		}
+	}
+
+	// ValCoord2DFast() of each lane
+	static SIMDf ValCoord(const FastNoise& noise, unsigned char offset, SIMDi x, SIMDi y)
+	{
+		unsigned char lutPos[FN_SIMD_LANES];
+		float v[FN_SIMD_LANES];
+		Index2D(noise, offset, x, y, false, lutPos);
+		for (int l = 0; l < FN_SIMD_LANES; l++)
+			v[l] = VAL_LUT[lutPos[l]];
+		return SIMDf_LOAD(v);
+	}
+
+	// GradCoord2D() of each lane
+	static SIMDf GradCoord(const FastNoise& noise, unsigned char offset, SIMDi x, SIMDi y, SIMDf xd, SIMDf yd)
+	{
+		unsigned char lutPos[FN_SIMD_LANES];
+		float gx[FN_SIMD_LANES], gy[FN_SIMD_LANES];
+		Index2D(noise, offset, x, y, true, lutPos);
+		for (int l = 0; l < FN_SIMD_LANES; l++)
+		{
+			gx[l] = GRAD_X[lutPos[l]];
+			gy[l] = GRAD_Y[lutPos[l]];
+		}
+		return SIMDf_ADD(SIMDf_MUL(xd, SIMDf_LOAD(gx)), SIMDf_MUL(yd, SIMDf_LOAD(gy)));
+	}
+
+	template <FastNoise::Interp I>
+	static SIMDf Value(const FastNoise& noise, unsigned char offset, SIMDf x, SIMDf y)
+	{
+		SIMDi x0 = SIMDi_FLOOR(x);
+		SIMDi y0 = SIMDi_FLOOR(y);
+
+		SIMDi x1 = SIMDi_ADD(x0, SIMDi_SET(1));
+		SIMDi y1 = SIMDi_ADD(y0, SIMDi_SET(1));
+
+		SIMDf xs = SIMDf_INTERP<I>(SIMDf_SUB(x, SIMDf_CONVERT_TO_FLOAT(x0)));
+		SIMDf ys = SIMDf_INTERP<I>(SIMDf_SUB(y, SIMDf_CONVERT_TO_FLOAT(y0)));
+
+		SIMDf xf0 = SIMDf_LERP(ValCoord(noise, offset, x0, y0), ValCoord(noise, offset, x1, y0), xs);
+		SIMDf xf1 = SIMDf_LERP(ValCoord(noise, offset, x0, y1), ValCoord(noise, offset, x1, y1), xs);
+
+		return SIMDf_LERP(xf0, xf1, ys);
+	}
+
+	template <FastNoise::Interp I>
+	static SIMDf Perlin(const FastNoise& noise, unsigned char offset, SIMDf x, SIMDf y)
+	{
+		SIMDi x0 = SIMDi_FLOOR(x);
+		SIMDi y0 = SIMDi_FLOOR(y);
+
+		SIMDf xd0 = SIMDf_SUB(x, SIMDf_CONVERT_TO_FLOAT(x0));
+		SIMDf yd0 = SIMDf_SUB(y, SIMDf_CONVERT_TO_FLOAT(y0));
+		SIMDf xd1 = SIMDf_SUB(xd0, SIMDf_SET(1));
+		SIMDf yd1 = SIMDf_SUB(yd0, SIMDf_SET(1));
+
+		SIMDf xs = SIMDf_INTERP<I>(xd0);
+		SIMDf ys = SIMDf_INTERP<I>(yd0);
+
+		SIMDi x1 = SIMDi_ADD(x0, SIMDi_SET(1));
+		SIMDi y1 = SIMDi_ADD(y0, SIMDi_SET(1));
+
+		SIMDf g00 = GradCoord(noise, offset, x0, y0, xd0, yd0);
+		SIMDf g10 = GradCoord(noise, offset, x1, y0, xd1, yd0);
+		SIMDf g01 = GradCoord(noise, offset, x0, y1, xd0, yd1);
+		SIMDf g11 = GradCoord(noise, offset, x1, y1, xd1, yd1);
+
+		SIMDf xf0 = SIMDf_LERP(g00, g10, xs);
+		SIMDf xf1 = SIMDf_LERP(g01, g11, xs);
+
+		return SIMDf_LERP(xf0, xf1, ys);
+	}
+
+	static SIMDf SimplexCorner(const FastNoise& noise, unsigned char offset, SIMDi x, SIMDi y, SIMDf xd, SIMDf yd)
+	{
+		SIMDf t = SIMDf_SUB(SIMDf_SUB(SIMDf_SET(0.5f), SIMDf_MUL(xd, xd)), SIMDf_MUL(yd, yd));
+		SIMDf t2 = SIMDf_MUL(t, t);
+		SIMDf n = SIMDf_MUL(SIMDf_MUL(t2, t2), GradCoord(noise, offset, x, y, xd, yd));
+
+		return SIMDf_BLENDV(n, SIMDf_SET(0), SIMDf_LESS_THAN(t, SIMDf_SET(0)));
+	}
+
+	static SIMDf Simplex(const FastNoise& noise, unsigned char offset, SIMDf x, SIMDf y)
+	{
+		SIMDf t = SIMDf_MUL(SIMDf_ADD(x, y), SIMDf_SET(F2));
+		SIMDi i = SIMDi_FLOOR(SIMDf_ADD(x, t));
+		SIMDi j = SIMDi_FLOOR(SIMDf_ADD(y, t));
+
+		t = SIMDf_MUL(SIMDf_CONVERT_TO_FLOAT(SIMDi_ADD(i, j)), SIMDf_SET(G2));
+		SIMDf x0 = SIMDf_SUB(x, SIMDf_SUB(SIMDf_CONVERT_TO_FLOAT(i), t));
+		SIMDf y0 = SIMDf_SUB(y, SIMDf_SUB(SIMDf_CONVERT_TO_FLOAT(j), t));
+
+		// i1 = 1, j1 = 0 where x0 > y0, otherwise i1 = 0, j1 = 1
+		SIMDf xGreater = SIMDf_LESS_THAN(y0, x0);
+		SIMDf i1 = SIMDf_BLENDV(SIMDf_SET(0), SIMDf_SET(1), xGreater);
+		SIMDf j1 = SIMDf_BLENDV(SIMDf_SET(1), SIMDf_SET(0), xGreater);
+
+		SIMDf x1 = SIMDf_ADD(SIMDf_SUB(x0, i1), SIMDf_SET(G2));
+		SIMDf y1 = SIMDf_ADD(SIMDf_SUB(y0, j1), SIMDf_SET(G2));
+		SIMDf x2 = SIMDf_ADD(SIMDf_SUB(x0, SIMDf_SET(1)), SIMDf_SET(2 * G2));
+		SIMDf y2 = SIMDf_ADD(SIMDf_SUB(y0, SIMDf_SET(1)), SIMDf_SET(2 * G2));
+
+		int ii[FN_SIMD_LANES], ji[FN_SIMD_LANES], i1i[FN_SIMD_LANES], j1i[FN_SIMD_LANES], i2i[FN_SIMD_LANES], j2i[FN_SIMD_LANES];
+		float i1f[FN_SIMD_LANES];
+		SIMDi_STORE(ii, i);
+		SIMDi_STORE(ji, j);
+		SIMDf_STORE(i1f, i1);
+		for (int l = 0; l < FN_SIMD_LANES; l++)
+		{
+			i1i[l] = ii[l] + (int)i1f[l];
+			j1i[l] = ji[l] + 1 - (int)i1f[l];
+			i2i[l] = ii[l] + 1;
+			j2i[l] = ji[l] + 1;
+		}
+
+		SIMDf n0 = SimplexCorner(noise, offset, i, j, x0, y0);
+		SIMDf n1 = SimplexCorner(noise, offset, SIMDi_LOAD(i1i), SIMDi_LOAD(j1i), x1, y1);
+		SIMDf n2 = SimplexCorner(noise, offset, SIMDi_LOAD(i2i), SIMDi_LOAD(j2i), x2, y2);
+
+		return SIMDf_MUL(SIMDf_SET(70), SIMDf_ADD(SIMDf_ADD(n0, n1), n2));
+	}
+
+	static SIMDf Cubic(const FastNoise& noise, unsigned char offset, SIMDf x, SIMDf y)
+	{
+		SIMDi x1 = SIMDi_FLOOR(x);
+		SIMDi y1 = SIMDi_FLOOR(y);
+
+		SIMDf xs = SIMDf_SUB(x, SIMDf_CONVERT_TO_FLOAT(x1));
+		SIMDf ys = SIMDf_SUB(y, SIMDf_CONVERT_TO_FLOAT(y1));
+
+		SIMDi x0 = SIMDi_ADD(x1, SIMDi_SET(-1));
+		SIMDi x2 = SIMDi_ADD(x1, SIMDi_SET(1));
+		SIMDi x3 = SIMDi_ADD(x1, SIMDi_SET(2));
+
+		SIMDf rows[4];
+		for (int r = 0; r < 4; r++)
+		{
+			SIMDi yr = SIMDi_ADD(y1, SIMDi_SET(r - 1));
+			rows[r] = SIMDf_CUBIC_LERP(ValCoord(noise, offset, x0, yr), ValCoord(noise, offset, x1, yr),
+				ValCoord(noise, offset, x2, yr), ValCoord(noise, offset, x3, yr), xs);
+		}
+
+		return SIMDf_MUL(SIMDf_CUBIC_LERP(rows[0], rows[1], rows[2], rows[3], ys), SIMDf_SET(CUBIC_2D_BOUNDING));
+	}
+
+	template <FastNoise::FractalType F, Kernel2D Kernel>
+	static SIMDf Fractal(const FastNoise& noise, SIMDf x, SIMDf y)
+	{
+		SIMDf lacunarity = SIMDf_SET(noise.m_lacunarity);
+		SIMDf sum;
+		FN_DECIMAL amp = 1;
+		int i = 0;
+
+		switch (F)
+		{
+		case FastNoise::FBM:
+			sum = Kernel(noise, noise.m_perm[0], x, y);
+
+			while (++i < noise.m_octaves)
+			{
+				x = SIMDf_MUL(x, lacunarity);
+				y = SIMDf_MUL(y, lacunarity);
+
+				amp *= noise.m_gain;
+				sum = SIMDf_ADD(sum, SIMDf_MUL(Kernel(noise, noise.m_perm[i], x, y), SIMDf_SET(amp)));
+			}
+
+			return SIMDf_MUL(sum, SIMDf_SET(noise.m_fractalBounding));
+		case FastNoise::Billow:
+			sum = SIMDf_SUB(SIMDf_MUL(SIMDf_ABS(Kernel(noise, noise.m_perm[0], x, y)), SIMDf_SET(2)), SIMDf_SET(1));
+
+			while (++i < noise.m_octaves)
+			{
+				x = SIMDf_MUL(x, lacunarity);
+				y = SIMDf_MUL(y, lacunarity);
+
+				amp *= noise.m_gain;
+				sum = SIMDf_ADD(sum, SIMDf_MUL(SIMDf_SUB(SIMDf_MUL(SIMDf_ABS(Kernel(noise, noise.m_perm[i], x, y)), SIMDf_SET(2)), SIMDf_SET(1)), SIMDf_SET(amp)));
+			}
+
+			return SIMDf_MUL(sum, SIMDf_SET(noise.m_fractalBounding));
+		case FastNoise::RigidMulti:
+		default:
+			sum = SIMDf_SUB(SIMDf_SET(1), SIMDf_ABS(Kernel(noise, noise.m_perm[0], x, y)));
+
+			while (++i < noise.m_octaves)
+			{
+				x = SIMDf_MUL(x, lacunarity);
+				y = SIMDf_MUL(y, lacunarity);
+
+				amp *= noise.m_gain;
+				sum = SIMDf_SUB(sum, SIMDf_MUL(SIMDf_SUB(SIMDf_SET(1), SIMDf_ABS(Kernel(noise, noise.m_perm[i], x, y))), SIMDf_SET(amp)));
+			}
+
+			return sum;
+		}
+	}
+
+
+	// Lattice kernel of a noise type, with the interpolation fixed. Kept out of line: inlined into
+	// the octave loop, Cubic's 16 lookups spill and a fractal fill ran up to 1.5x slower.
+	template <FastNoise::NoiseType Type, FastNoise::Interp I>
+	static FN_NOINLINE SIMDf Lattice(const FastNoise& noise, unsigned char offset, SIMDf x, SIMDf y)
+	{
+		switch (Type)
+		{
+		case FastNoise::Value:
+		case FastNoise::ValueFractal:
+			return Value<I>(noise, offset, x, y);
+		case FastNoise::Perlin:
+		case FastNoise::PerlinFractal:
+			return Perlin<I>(noise, offset, x, y);
+		case FastNoise::Simplex:
+		case FastNoise::SimplexFractal:
+			return Simplex(noise, offset, x, y);
+		default:
+			return Cubic(noise, offset, x, y);
+		}
+	}
+
+	// A fully specialized pipeline, e.g. NoiseKernel<FastNoise::PerlinFractal, FastNoise::FBM, FastNoise::Quintic>.
+	// The type, fractal and interpolation are template parameters, so the per sample and per octave
+	// switches fold away. F is ignored by the single octave types and I by Simplex and Cubic.
+	template <FastNoise::NoiseType Type, FastNoise::FractalType F, FastNoise::Interp I>
+	struct NoiseKernel
+	{
+		static SIMDf Sample(const FastNoise& noise, SIMDf x, SIMDf y)
+		{
+			switch (Type)
+			{
+			case FastNoise::ValueFractal:
+			case FastNoise::PerlinFractal:
+			case FastNoise::SimplexFractal:
+			case FastNoise::CubicFractal:
+				return Fractal<F, Lattice<Type, I> >(noise, x, y);
+			default:
+				return Lattice<Type, I>(noise, 0, x, y);
+			}
+		}
+	};
+
+	template <class Kernel>
+	static void Fill(const FastNoise& noise, FN_DECIMAL* noiseOut, int x0, int y0, int width, int height, FN_DECIMAL step)
+	{
+		const float laneIndex[FN_SIMD_LANES] = { 0, 1, 2, 3 };
+		SIMDf laneOffset = SIMDf_LOAD(laneIndex);
+		SIMDf xStart = SIMDf_SET((FN_DECIMAL)x0);
+		SIMDf stepV = SIMDf_SET(step);
+		SIMDf frequency = SIMDf_SET(noise.m_frequency);
+		float tail[FN_SIMD_LANES];
+
+		for (int j = 0; j < height; j++)
+		{
+			SIMDf y = SIMDf_SET(((FN_DECIMAL)y0 + (FN_DECIMAL)j * step) * noise.m_frequency);
+
+			for (int i = 0; i < width; i += FN_SIMD_LANES)
+			{
+				SIMDf x = SIMDf_ADD(SIMDf_SET((FN_DECIMAL)i), laneOffset);
+				x = SIMDf_MUL(SIMDf_ADD(xStart, SIMDf_MUL(x, stepV)), frequency);
+
+				SIMDf result = Kernel::Sample(noise, x, y);
+
+				if (width - i >= FN_SIMD_LANES)
+				{
+					SIMDf_STORE(noiseOut + i, result);
+				}
+				else
+				{
+					SIMDf_STORE(tail, result);
+					for (int l = 0; l < width - i; l++)
+						noiseOut[i + l] = tail[l];
+				}
+			}
+
+			noiseOut += width;
+		}
+	}
+
+	// Runtime factory: resolves the generator's settings to one Fill<NoiseKernel<...> > per call
+	typedef void(*Fill2D)(const FastNoise& noise, FN_DECIMAL* noiseOut, int x0, int y0, int width, int height, FN_DECIMAL step);
+
+	template <FastNoise::NoiseType Type, FastNoise::FractalType F>
+	static Fill2D SelectInterp(const FastNoise& noise)
+	{
+		switch (noise.m_interp)
+		{
+		case FastNoise::Linear:
+			return Fill<NoiseKernel<Type, F, FastNoise::Linear> >;
+		case FastNoise::Hermite:
+			return Fill<NoiseKernel<Type, F, FastNoise::Hermite> >;
+		default:
+			return Fill<NoiseKernel<Type, F, FastNoise::Quintic> >;
+		}
+	}
+
+	// Interpolated is false for the types that don't interpolate, so they get one instantiation per fractal
+	template <FastNoise::NoiseType Type, bool Interpolated>
+	static Fill2D SelectFractal(const FastNoise& noise)
+	{
+		switch (noise.m_fractalType)
+		{
+		case FastNoise::FBM:
+			return Interpolated ? SelectInterp<Type, FastNoise::FBM>(noise) : Fill<NoiseKernel<Type, FastNoise::FBM, FastNoise::Quintic> >;
+		case FastNoise::Billow:
+			return Interpolated ? SelectInterp<Type, FastNoise::Billow>(noise) : Fill<NoiseKernel<Type, FastNoise::Billow, FastNoise::Quintic> >;
+		default:
+			return Interpolated ? SelectInterp<Type, FastNoise::RigidMulti>(noise) : Fill<NoiseKernel<Type, FastNoise::RigidMulti, FastNoise::Quintic> >;
+		}
+	}
+
+	// Null for the types without a lane kernel
+	static Fill2D Select(const FastNoise& noise)
+	{
+		switch (noise.m_noiseType)
+		{
+		case FastNoise::Value:
+			return SelectInterp<FastNoise::Value, FastNoise::FBM>(noise);
+		case FastNoise::ValueFractal:
+			return SelectFractal<FastNoise::ValueFractal, true>(noise);
+		case FastNoise::Perlin:
+			return SelectInterp<FastNoise::Perlin, FastNoise::FBM>(noise);
+		case FastNoise::PerlinFractal:
+			return SelectFractal<FastNoise::PerlinFractal, true>(noise);
+		case FastNoise::Simplex:
+			return Fill<NoiseKernel<FastNoise::Simplex, FastNoise::FBM, FastNoise::Quintic> >;
+		case FastNoise::SimplexFractal:
+			return SelectFractal<FastNoise::SimplexFractal, false>(noise);
+		case FastNoise::Cubic:
+			return Fill<NoiseKernel<FastNoise::Cubic, FastNoise::FBM, FastNoise::Quintic> >;
+		case FastNoise::CubicFractal:
+			return SelectFractal<FastNoise::CubicFractal, false>(noise);
+		default:
+			return 0;
+		}
+	}
+	// Cellular, one row of samples at a time. The samples of a row share y (and z), so their
+	// candidate cells only differ by column: each cell's feature point is hashed once per row into
+	// a table, instead of 9 or 27 times per sample, and the lanes read it from there. Candidates are
+	// visited in the scalar loops' order with the same arithmetic, so the nearest cells and
+	// distances match SingleCellular() and SingleCellular2Edge() bit for bit.
+	struct CellularRow
+	{
+		int xMin; // Column of the first cell in the table
+		int cellRows; // 3 in 2D, 9 in 3D, in the scalar loops' (yi, zi) order
+		int yr, zr;
+		std::vector<float> jitterX; // [(xi - xMin) * cellRows + cellRow]
+		std::vector<float> vecY;
+		std::vector<float> vecZ;
+		float bound[9]; // Least distance any cell of a cell row can be at, whatever the sample's x
+	};
+
+	template <int Function, bool Is3D>
+	static inline SIMDf CellularDistance(SIMDf vx, SIMDf vy, SIMDf vz)
+	{
+		switch (Function)
+		{
+		case FastNoise::Manhattan:
+			return Is3D ? SIMDf_ADD(SIMDf_ADD(SIMDf_ABS(vx), SIMDf_ABS(vy)), SIMDf_ABS(vz)) : SIMDf_ADD(SIMDf_ABS(vx), SIMDf_ABS(vy));
+		case FastNoise::Natural:
+			return SIMDf_ADD(CellularDistance<FastNoise::Manhattan, Is3D>(vx, vy, vz), CellularDistance<FastNoise::Euclidean, Is3D>(vx, vy, vz));
+		default:
+			return Is3D ? SIMDf_ADD(SIMDf_ADD(SIMDf_MUL(vx, vx), SIMDf_MUL(vy, vy)), SIMDf_MUL(vz, vz)) : SIMDf_ADD(SIMDf_MUL(vx, vx), SIMDf_MUL(vy, vy));
+		}
+	}
+
+	template <int Function, bool Is3D>
+	static void CellularRowTable(const FastNoise& noise, CellularRow& row, int columns, FN_DECIMAL y, FN_DECIMAL z)
+	{
+		row.yr = FastRound(y);
+		row.zr = Is3D ? FastRound(z) : 0;
+		for (int k = 0; k < row.cellRows; k++)
+			row.bound[k] = 999999;
+
+		for (int c = 0; c < columns; c++)
+		{
+			int xi = row.xMin + c;
+
+			for (int k = 0; k < row.cellRows; k++)
+			{
+				size_t cell = (size_t)c * row.cellRows + k;
+				FN_DECIMAL vecZ = 0;
+
+				if (Is3D)
+				{
+					int yi = row.yr - 1 + k / 3;
+					int zi = row.zr - 1 + k % 3;
+					unsigned char lutPos = noise.Index3D_256(0, xi, yi, zi);
+
+					row.jitterX[cell] = CELL_3D_X[lutPos] * noise.m_cellularJitter;
+					row.vecY[cell] = yi - y + CELL_3D_Y[lutPos] * noise.m_cellularJitter;
+					row.vecZ[cell] = vecZ = zi - z + CELL_3D_Z[lutPos] * noise.m_cellularJitter;
+				}
+				else
+				{
+					int yi = row.yr - 1 + k;
+					unsigned char lutPos = noise.Index2D_256(0, xi, yi);
+
+					row.jitterX[cell] = CELL_2D_X[lutPos] * noise.m_cellularJitter;
+					row.vecY[cell] = yi - y + CELL_2D_Y[lutPos] * noise.m_cellularJitter;
+				}
+
+				// The distance only grows with |vecX|, so the one at vecX = 0 is a lower bound
+				float least[FN_SIMD_LANES];
+				SIMDf_STORE(least, CellularDistance<Function, Is3D>(SIMDf_SET(0), SIMDf_SET(row.vecY[cell]), SIMDf_SET(vecZ)));
+				row.bound[k] = fmin(row.bound[k], least[0]);
+			}
+		}
+	}
+
+	template <int Function, bool Is3D>
+	static SIMDf Cellular(const FastNoise& noise, const CellularRow& row, SIMDf x, FastNoiseLookupCache& lookupCache)
+	{
+		float xf[FN_SIMD_LANES];
+		int xr[FN_SIMD_LANES], first[FN_SIMD_LANES];
+		SIMDf_STORE(xf, x);
+		for (int l = 0; l < FN_SIMD_LANES; l++)
+		{
+			xr[l] = FastRound(xf[l]);
+			first[l] = (xr[l] - 1 - row.xMin) * row.cellRows;
+		}
+
+		// Lanes in the same column read the same cells, most of them do below a frequency of 1
+		bool shared = xr[0] == xr[FN_SIMD_LANES - 1];
+		bool twoEdge = noise.m_cellularReturnType != FastNoise::CellValue &&
+			noise.m_cellularReturnType != FastNoise::NoiseLookup &&
+			noise.m_cellularReturnType != FastNoise::Distance;
+		int index0 = noise.m_cellularDistanceIndex0;
+		int index1 = noise.m_cellularDistanceIndex1;
+
+		SIMDf distance[FN_CELLULAR_INDEX_MAX + 1];
+		for (int i = 0; i <= FN_CELLULAR_INDEX_MAX; i++)
+			distance[i] = SIMDf_SET(999999);
+		SIMDf closest = SIMDf_SET(0); // Candidate number of the nearest cell
+
+		for (int dx = 0; dx < 3; dx++)
+		{
+			float xi[FN_SIMD_LANES];
+			for (int l = 0; l < FN_SIMD_LANES; l++)
+				xi[l] = (FN_DECIMAL)(xr[l] - 1 + dx);
+			SIMDf xd = SIMDf_SUB(SIMDf_LOAD(xi), x);
+
+			for (int k = 0; k < row.cellRows; k++)
+			{
+				// Skip the cell when it can't change any lane's result
+				SIMDf limit = twoEdge ? distance[index1] : distance[0];
+				if (!SIMDf_ANY(SIMDf_LESS_THAN(SIMDf_SET(row.bound[k]), limit)))
+					continue;
+
+				int n = dx * row.cellRows + k;
+				SIMDf jitterX, vecY, vecZ;
+
+				if (shared)
+				{
+					size_t cell = (size_t)(first[0] + n);
+					jitterX = SIMDf_SET(row.jitterX[cell]);
+					vecY = SIMDf_SET(row.vecY[cell]);
+					vecZ = Is3D ? SIMDf_SET(row.vecZ[cell]) : vecY;
+				}
+				else
+				{
+					float jx[FN_SIMD_LANES], vy[FN_SIMD_LANES], vz[FN_SIMD_LANES];
+					for (int l = 0; l < FN_SIMD_LANES; l++)
+					{
+						size_t cell = (size_t)(first[l] + n);
+						jx[l] = row.jitterX[cell];
+						vy[l] = row.vecY[cell];
+						vz[l] = Is3D ? row.vecZ[cell] : 0;
+					}
+					jitterX = SIMDf_LOAD(jx);
+					vecY = SIMDf_LOAD(vy);
+					vecZ = SIMDf_LOAD(vz);
+				}
+
+				SIMDf newDistance = CellularDistance<Function, Is3D>(SIMDf_ADD(xd, jitterX), vecY, vecZ);
+
+				if (twoEdge)
+				{
+					for (int i = index1; i > 0; i--)
+						distance[i] = SIMDf_MAX(SIMDf_MIN(distance[i], newDistance), distance[i - 1]);
+					distance[0] = SIMDf_MIN(distance[0], newDistance);
+				}
+				else
+				{
+					SIMDf closer = SIMDf_LESS_THAN(newDistance, distance[0]);
+					distance[0] = SIMDf_BLENDV(distance[0], newDistance, closer);
+					closest = SIMDf_BLENDV(closest, SIMDf_SET((FN_DECIMAL)n), closer);
+				}
+			}
+		}
+
+		switch (noise.m_cellularReturnType)
+		{
+		case FastNoise::CellValue:
+		case FastNoise::NoiseLookup:
+		{
+			float candidate[FN_SIMD_LANES], result[FN_SIMD_LANES];
+			SIMDf_STORE(candidate, closest);
+
+			for (int l = 0; l < FN_SIMD_LANES; l++)
+			{
+				int n = (int)candidate[l];
+				int k = n % row.cellRows;
+				int xc = xr[l] - 1 + n / row.cellRows;
+				int yc = row.yr - 1 + (Is3D ? k / 3 : k);
+				int zc = row.zr - 1 + k % 3;
+
+				if (noise.m_cellularReturnType == FastNoise::CellValue)
+					result[l] = Is3D ? ValCoord3D(noise.m_seed, xc, yc, zc) : ValCoord2D(noise.m_seed, xc, yc);
+				else
+					result[l] = Is3D ? noise.CellularLookup(xc, yc, zc, &lookupCache) : noise.CellularLookup(xc, yc, &lookupCache);
+			}
+			return SIMDf_LOAD(result);
+		}
+		case FastNoise::Distance:
+			return distance[0];
+		case FastNoise::Distance2:
+			return distance[index1];
+		case FastNoise::Distance2Add:
+			return SIMDf_ADD(distance[index1], distance[index0]);
+		case FastNoise::Distance2Sub:
+			return SIMDf_SUB(distance[index1], distance[index0]);
+		case FastNoise::Distance2Mul:
+			return SIMDf_MUL(distance[index1], distance[index0]);
+		case FastNoise::Distance2Div:
+			return SIMDf_DIV(distance[index0], distance[index1]);
+		default:
+			return SIMDf_SET(0);
+		}
+	}
+
+	template <int Function, bool Is3D>
+	static bool FillCellular(const FastNoise& noise, FN_DECIMAL* noiseOut, int x0, int y0, int z0, int width, int height, int depth, FN_DECIMAL step)
+	{
+		const float laneIndex[FN_SIMD_LANES] = { 0, 1, 2, 3 };
+		SIMDf laneOffset = SIMDf_LOAD(laneIndex);
+		SIMDf xStart = SIMDf_SET((FN_DECIMAL)x0);
+		SIMDf stepV = SIMDf_SET(step);
+		SIMDf frequency = SIMDf_SET(noise.m_frequency);
+		float tail[FN_SIMD_LANES];
+
+		// x is monotonic along the row, so the first and last groups of lanes (including the
+		// lanes past width) bound the columns the row reaches
+		int lastGroup = (width - 1) / FN_SIMD_LANES * FN_SIMD_LANES;
+		float firstX[FN_SIMD_LANES], lastX[FN_SIMD_LANES];
+		SIMDf_STORE(firstX, SIMDf_MUL(SIMDf_ADD(xStart, SIMDf_MUL(laneOffset, stepV)), frequency));
+		SIMDf_STORE(lastX, SIMDf_MUL(SIMDf_ADD(xStart, SIMDf_MUL(SIMDf_ADD(SIMDf_SET((FN_DECIMAL)lastGroup), laneOffset), stepV)), frequency));
+
+		int xrMin = FastRound(firstX[0]);
+		int xrMax = xrMin;
+		for (int l = 0; l < FN_SIMD_LANES; l++)
+		{
+			xrMin = std::min(xrMin, std::min(FastRound(firstX[l]), FastRound(lastX[l])));
+			xrMax = std::max(xrMax, std::max(FastRound(firstX[l]), FastRound(lastX[l])));
+		}
+
+		// At high frequencies neighbouring samples share no cells, the table would only add work
+		int columns = xrMax - xrMin + 3;
+		if (columns > 2 * width + 3)
+			return false;
+
+		CellularRow row;
+		FastNoiseLookupCache lookupCache;
+		row.xMin = xrMin - 1;
+		row.cellRows = Is3D ? 9 : 3;
+		row.jitterX.resize((size_t)columns * row.cellRows);
+		row.vecY.resize(row.jitterX.size());
+		if (Is3D)
+			row.vecZ.resize(row.jitterX.size());
+
+		for (int k = 0; k < depth; k++)
+		{
+			FN_DECIMAL z = ((FN_DECIMAL)z0 + (FN_DECIMAL)k * step) * noise.m_frequency;
+
+			for (int j = 0; j < height; j++)
+			{
+				FN_DECIMAL y = ((FN_DECIMAL)y0 + (FN_DECIMAL)j * step) * noise.m_frequency;
+				CellularRowTable<Function, Is3D>(noise, row, columns, y, z);
+
+				for (int i = 0; i < width; i += FN_SIMD_LANES)
+				{
+					SIMDf x = SIMDf_ADD(SIMDf_SET((FN_DECIMAL)i), laneOffset);
+					x = SIMDf_MUL(SIMDf_ADD(xStart, SIMDf_MUL(x, stepV)), frequency);
+
+					SIMDf result = Cellular<Function, Is3D>(noise, row, x, lookupCache);
+
+					if (width - i >= FN_SIMD_LANES)
+					{
+						SIMDf_STORE(noiseOut + i, result);
+					}
+					else
+					{
+						SIMDf_STORE(tail, result);
+						for (int l = 0; l < width - i; l++)
+							noiseOut[i + l] = tail[l];
+					}
+				}
+
+				noiseOut += width;
+			}
+		}
+
+		return true;
+	}
+
+	static bool FillCellular(const FastNoise& noise, bool is3D, FN_DECIMAL* noiseOut, int x0, int y0, int z0, int width, int height, int depth, FN_DECIMAL step)
+	{
+		assert(noise.m_cellularReturnType != FastNoise::NoiseLookup || noise.m_cellularNoiseLookup);
+
+		switch (noise.m_cellularDistanceFunction)
+		{
+		case FastNoise::Manhattan:
+			return is3D ? FillCellular<FastNoise::Manhattan, true>(noise, noiseOut, x0, y0, z0, width, height, depth, step) :
+				FillCellular<FastNoise::Manhattan, false>(noise, noiseOut, x0, y0, z0, width, height, depth, step);
+		case FastNoise::Natural:
+			return is3D ? FillCellular<FastNoise::Natural, true>(noise, noiseOut, x0, y0, z0, width, height, depth, step) :
+				FillCellular<FastNoise::Natural, false>(noise, noiseOut, x0, y0, z0, width, height, depth, step);
+		default:
+			return is3D ? FillCellular<FastNoise::Euclidean, true>(noise, noiseOut, x0, y0, z0, width, height, depth, step) :
+				FillCellular<FastNoise::Euclidean, false>(noise, noiseOut, x0, y0, z0, width, height, depth, step);
+		}
+	}
+};
+
+bool FastNoise::FillGrid2DSIMD(FN_DECIMAL* noiseOut, int x0, int y0, int width, int height, FN_DECIMAL step) const
+{
+	if (m_noiseType == Cellular)
+		return FastNoiseGrid::FillCellular(*this, false, noiseOut, x0, y0, 0, width, height, 1, step);
+
+	FastNoiseGrid::Fill2D fill = FastNoiseGrid::Select(*this);
+	if (!fill)
+		return false;
+
+	fill(*this, noiseOut, x0, y0, width, height, step);
+	return true;
+}
+
+bool FastNoise::FillGrid3DSIMD(FN_DECIMAL* noiseOut, int x0, int y0, int z0, int width, int height, int depth, FN_DECIMAL step) const
+{
+	if (m_noiseType != Cellular)
+		return false;
+
+	return FastNoiseGrid::FillCellular(*this, true, noiseOut, x0, y0, z0, width, height, depth, step);
+}
+#else
+bool FastNoise::FillGrid2DSIMD(FN_DECIMAL*, int, int, int, int, FN_DECIMAL) const
+{
+	return false;
+}
+
+bool FastNoise::FillGrid3DSIMD(FN_DECIMAL*, int, int, int, int, int, int, FN_DECIMAL) const
+{
+	return false;
+}
+#endif
@@ -62,17 +62,22 @@ class nullptr_t
 const nullptr_t null = {};
 #endif
 
+struct FastNoiseLookupCache;
+
+// All Get*() and FillGrid*() functions are const and only read the settings and permutation tables,
+// so one configured FastNoise can be sampled from any number of threads at once without copying it.
+// Calling a Set*() function while another thread is sampling is not safe.
 class FastNoise
 {
 public:
 	FastNoise(int seed = 1337) { SetSeed(seed); CalculateFractalBounding(); };
-	~FastNoise() { delete m_cellularNoiseLookup; }
 
 	enum NoiseType { Value, ValueFractal, Perlin, PerlinFractal, Simplex, SimplexFractal, Cellular, WhiteNoise, Cubic, CubicFractal };
 	enum Interp { Linear, Hermite, Quintic };
 	enum FractalType { FBM, Billow, RigidMulti };
 	enum CellularDistanceFunction { Euclidean, Manhattan, Natural };
 	enum CellularReturnType { CellValue, NoiseLookup, Distance, Distance2, Distance2Add, Distance2Sub, Distance2Mul, Distance2Div };
+	enum HashType { PermutationTable, IntegerHash };
 
 	// Returns seed used for all noise types
 	void SetSeed(int seed);
@@ -81,6 +86,14 @@ public:
 	// Default: 1337
 	int GetSeed(void) const { return m_seed; }
 
+	// Sets how lattice points are hashed into gradients and values
+	// - PermutationTable: a 256 entry table shuffled from the seed by SetSeed()
+	// - IntegerHash: multiplies and xorshifts of the seed and coordinates, so SetSeed() is O(1)
+	//   and FillGrid2D() hashes 4 lanes at once. Looks the same but gives different values.
+	// Default: PermutationTable
+	void SetHashType(HashType hashType);
+	HashType GetHashType(void) const { return m_hashType; }
+
 	// Sets frequency for all noise types
 	// Default: 0.01
 	void SetFrequency(FN_DECIMAL frequency) { m_frequency = frequency; }
@@ -127,7 +140,9 @@ public:
 	
 	// Noise used to calculate a cell value if cellular return type is NoiseLookup
 	// The lookup value is acquired through GetNoise() so ensure you SetNoiseType() on the noise lookup, value, Perlin or simplex is recommended
-	void SetCellularNoiseLookup(FastNoise* noise) { m_cellularNoiseLookup = noise; }
+	// The lookup is not owned, it must outlive this object and should not be reconfigured while this object is being sampled
+	void SetCellularNoiseLookup(const FastNoise* noise) { m_cellularNoiseLookup = noise; }
+	const FastNoise* GetCellularNoiseLookup(void) const { return m_cellularNoiseLookup; }
 
 	// Sets the 2 distance indicies used for distance2 return types
 	// Default: 0, 1
@@ -146,62 +161,88 @@ public:
 	void SetGradientPerturbAmp(FN_DECIMAL gradientPerturbAmp) { m_gradientPerturbAmp = gradientPerturbAmp; }
 
 	//2D												
-	FN_DECIMAL GetValue(FN_DECIMAL x, FN_DECIMAL y);					
-	FN_DECIMAL GetValueFractal(FN_DECIMAL x, FN_DECIMAL y);			
+	FN_DECIMAL GetValue(FN_DECIMAL x, FN_DECIMAL y) const;					
+	FN_DECIMAL GetValueFractal(FN_DECIMAL x, FN_DECIMAL y) const;			
+
+	FN_DECIMAL GetPerlin(FN_DECIMAL x, FN_DECIMAL y) const;				
+	FN_DECIMAL GetPerlinFractal(FN_DECIMAL x, FN_DECIMAL y) const;			
+
+	FN_DECIMAL GetSimplex(FN_DECIMAL x, FN_DECIMAL y) const;					
+	FN_DECIMAL GetSimplexFractal(FN_DECIMAL x, FN_DECIMAL y) const;			
+
+	FN_DECIMAL GetCellular(FN_DECIMAL x, FN_DECIMAL y) const;				
 
-	FN_DECIMAL GetPerlin(FN_DECIMAL x, FN_DECIMAL y);				
-	FN_DECIMAL GetPerlinFractal(FN_DECIMAL x, FN_DECIMAL y);			
+	FN_DECIMAL GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y) const;				
+	FN_DECIMAL GetWhiteNoiseInt(int x, int y) const;
 
-	FN_DECIMAL GetSimplex(FN_DECIMAL x, FN_DECIMAL y);					
-	FN_DECIMAL GetSimplexFractal(FN_DECIMAL x, FN_DECIMAL y);			
+	FN_DECIMAL GetCubic(FN_DECIMAL x, FN_DECIMAL y) const;
+	FN_DECIMAL GetCubicFractal(FN_DECIMAL x, FN_DECIMAL y) const;
 
-	FN_DECIMAL GetCellular(FN_DECIMAL x, FN_DECIMAL y);				
+	FN_DECIMAL GetNoise(FN_DECIMAL x, FN_DECIMAL y) const;
 
-	FN_DECIMAL GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y);				
-	FN_DECIMAL GetWhiteNoiseInt(int x, int y);
+	// Return the same values as GetValue(), GetPerlin(), GetSimplex() and their fractals, and set dx, dy to
+	// the noise's partial derivatives with respect to x and y, frequency included
+	// One evaluation instead of 3 to 5 for finite differences: a heightmap scaled by h has the normal
+	// normalize(-dx * h, 1, -dy * h)
+	FN_DECIMAL GetValueDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const;
+	FN_DECIMAL GetValueFractalDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const;
 
-	FN_DECIMAL GetCubic(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL GetCubicFractal(FN_DECIMAL x, FN_DECIMAL y);
+	FN_DECIMAL GetPerlinDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const;
+	FN_DECIMAL GetPerlinFractalDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const;
 
-	FN_DECIMAL GetNoise(FN_DECIMAL x, FN_DECIMAL y);
+	FN_DECIMAL GetSimplexDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const;
+	FN_DECIMAL GetSimplexFractalDeriv(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const;
 
-	void GradientPerturb(FN_DECIMAL& x, FN_DECIMAL& y);
-	void GradientPerturbFractal(FN_DECIMAL& x, FN_DECIMAL& y);
+	void GradientPerturb(FN_DECIMAL& x, FN_DECIMAL& y) const;
+	void GradientPerturbFractal(FN_DECIMAL& x, FN_DECIMAL& y) const;
 
 	//3D												
-	FN_DECIMAL GetValue(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);			
-	FN_DECIMAL GetValueFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);	
+	FN_DECIMAL GetValue(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;			
+	FN_DECIMAL GetValueFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;	
 
-	FN_DECIMAL GetPerlin(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);		
-	FN_DECIMAL GetPerlinFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
+	FN_DECIMAL GetPerlin(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;		
+	FN_DECIMAL GetPerlinFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
 
-	FN_DECIMAL GetSimplex(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);		
-	FN_DECIMAL GetSimplexFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);	
+	FN_DECIMAL GetSimplex(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;		
+	FN_DECIMAL GetSimplexFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;	
 
-	FN_DECIMAL GetCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);		
+	FN_DECIMAL GetCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;		
 
-	FN_DECIMAL GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);		
-	FN_DECIMAL GetWhiteNoiseInt(int x, int y, int z);
+	FN_DECIMAL GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;		
+	FN_DECIMAL GetWhiteNoiseInt(int x, int y, int z) const;
 
-	FN_DECIMAL GetCubic(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-	FN_DECIMAL GetCubicFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
+	FN_DECIMAL GetCubic(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	FN_DECIMAL GetCubicFractal(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
 
-	FN_DECIMAL GetNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
+	FN_DECIMAL GetNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
 
-	void GradientPerturb(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z);
-	void GradientPerturbFractal(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z);
+	void GradientPerturb(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z) const;
+	void GradientPerturbFractal(FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z) const;
+
+	//Grid
+	// Fills noiseOut with width * height GetNoise() samples, row major with x varying fastest
+	// Sample (i, j) is taken at (x0 + i * step, y0 + j * step), so step > 1 gives a downsampled grid
+	// The noise type is resolved once per call instead of once per sample, and Value, Perlin,
+	// Simplex and Cubic (including their fractals) are evaluated 4 samples at a time where SSE2 or NEON is available
+	// Cellular is too, with each row's cells hashed once and shared by the samples that fall next to them
+	void FillGrid2D(FN_DECIMAL* noiseOut, int x0, int y0, int width, int height, FN_DECIMAL step = 1) const;
+
+	// Same as FillGrid2D() for a width * height * depth volume, x varying fastest and z slowest
+	// Only Cellular has a SIMD path in 3D
+	void FillGrid3D(FN_DECIMAL* noiseOut, int x0, int y0, int z0, int width, int height, int depth, FN_DECIMAL step = 1) const;
 
 	//4D
-	FN_DECIMAL GetSimplex(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w);
+	FN_DECIMAL GetSimplex(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w) const;
 
-	FN_DECIMAL GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w);
-	FN_DECIMAL GetWhiteNoiseInt(int x, int y, int z, int w);
+	FN_DECIMAL GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w) const;
+	FN_DECIMAL GetWhiteNoiseInt(int x, int y, int z, int w) const;
 
 protected:
 	unsigned char m_perm[512];
 	unsigned char m_perm12[512];
 
 	int m_seed = 1337;
+	HashType m_hashType = PermutationTable;
 	FN_DECIMAL m_frequency = FN_DECIMAL(0.01);
 	Interp m_interp = Quintic;
 	NoiseType m_noiseType = Simplex;
@@ -215,9 +256,9 @@ protected:
 	CellularDistanceFunction m_cellularDistanceFunction = Euclidean;
 	CellularReturnType m_cellularReturnType = CellValue;
 #if defined(__llvm__)
-	FastNoise* m_cellularNoiseLookup = null;
+	const FastNoise* m_cellularNoiseLookup = null;
 #else
-	FastNoise* m_cellularNoiseLookup = nullptr;
+	const FastNoise* m_cellularNoiseLookup = nullptr;
 #endif
 	int m_cellularDistanceIndex0 = 0;
 	int m_cellularDistanceIndex1 = 1;
@@ -228,72 +269,97 @@ protected:
 	void CalculateFractalBounding();
 
 	//2D
-	FN_DECIMAL SingleValueFractalFBM(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL SingleValueFractalBillow(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL SingleValueFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL SingleValue(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y);
-
-	FN_DECIMAL SinglePerlinFractalFBM(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL SinglePerlinFractalBillow(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL SinglePerlinFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL SinglePerlin(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y);
+	FN_DECIMAL SingleValueFractalFBM(FN_DECIMAL x, FN_DECIMAL y) const;
+	FN_DECIMAL SingleValueFractalBillow(FN_DECIMAL x, FN_DECIMAL y) const;
+	FN_DECIMAL SingleValueFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y) const;
+	FN_DECIMAL SingleValue(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y) const;
+
+	FN_DECIMAL SinglePerlinFractalFBM(FN_DECIMAL x, FN_DECIMAL y) const;
+	FN_DECIMAL SinglePerlinFractalBillow(FN_DECIMAL x, FN_DECIMAL y) const;
+	FN_DECIMAL SinglePerlinFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y) const;
+	FN_DECIMAL SinglePerlin(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y) const;
+
+	FN_DECIMAL SingleSimplexFractalFBM(FN_DECIMAL x, FN_DECIMAL y) const;
+	FN_DECIMAL SingleSimplexFractalBillow(FN_DECIMAL x, FN_DECIMAL y) const;
+	FN_DECIMAL SingleSimplexFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y) const;
+	FN_DECIMAL SingleSimplexFractalBlend(FN_DECIMAL x, FN_DECIMAL y) const;
+	FN_DECIMAL SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y) const;
+
+	FN_DECIMAL SingleCubicFractalFBM(FN_DECIMAL x, FN_DECIMAL y) const;
+	FN_DECIMAL SingleCubicFractalBillow(FN_DECIMAL x, FN_DECIMAL y) const;
+	FN_DECIMAL SingleCubicFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y) const;
+	FN_DECIMAL SingleCubic(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y) const;
 
-	FN_DECIMAL SingleSimplexFractalFBM(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL SingleSimplexFractalBillow(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL SingleSimplexFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL SingleSimplexFractalBlend(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y);
-
-	FN_DECIMAL SingleCubicFractalFBM(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL SingleCubicFractalBillow(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL SingleCubicFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL SingleCubic(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y);
+#if defined(__llvm__)
+	FN_DECIMAL SingleCellular(FN_DECIMAL x, FN_DECIMAL y, FastNoiseLookupCache* lookupCache = null) const;
+#else
+	FN_DECIMAL SingleCellular(FN_DECIMAL x, FN_DECIMAL y, FastNoiseLookupCache* lookupCache = nullptr) const;
+#endif
+	FN_DECIMAL SingleCellular2Edge(FN_DECIMAL x, FN_DECIMAL y) const;
 
-	FN_DECIMAL SingleCellular(FN_DECIMAL x, FN_DECIMAL y);
-	FN_DECIMAL SingleCellular2Edge(FN_DECIMAL x, FN_DECIMAL y);
+	void SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp, FN_DECIMAL frequency, FN_DECIMAL& x, FN_DECIMAL& y) const;
 
-	void SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp, FN_DECIMAL frequency, FN_DECIMAL& x, FN_DECIMAL& y);
+	typedef FN_DECIMAL(FastNoise::*DerivKernel)(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const;
+	FN_DECIMAL SingleValueDeriv(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const;
+	FN_DECIMAL SinglePerlinDeriv(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const;
+	FN_DECIMAL SingleSimplexDeriv(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const;
+	FN_DECIMAL SingleFractalDeriv(DerivKernel kernel, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL& dx, FN_DECIMAL& dy) const;
 
 	//3D
-	FN_DECIMAL SingleValueFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-	FN_DECIMAL SingleValueFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-	FN_DECIMAL SingleValueFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-	FN_DECIMAL SingleValue(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-
-	FN_DECIMAL SinglePerlinFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-	FN_DECIMAL SinglePerlinFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-	FN_DECIMAL SinglePerlinFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-	FN_DECIMAL SinglePerlin(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-
-	FN_DECIMAL SingleSimplexFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-	FN_DECIMAL SingleSimplexFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-	FN_DECIMAL SingleSimplexFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-	FN_DECIMAL SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-
-	FN_DECIMAL SingleCubicFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-	FN_DECIMAL SingleCubicFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-	FN_DECIMAL SingleCubicFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-	FN_DECIMAL SingleCubic(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
+	FN_DECIMAL SingleValueFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	FN_DECIMAL SingleValueFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	FN_DECIMAL SingleValueFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	FN_DECIMAL SingleValue(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+
+	FN_DECIMAL SinglePerlinFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	FN_DECIMAL SinglePerlinFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	FN_DECIMAL SinglePerlinFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	FN_DECIMAL SinglePerlin(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+
+	FN_DECIMAL SingleSimplexFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	FN_DECIMAL SingleSimplexFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	FN_DECIMAL SingleSimplexFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	FN_DECIMAL SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+
+	FN_DECIMAL SingleCubicFractalFBM(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	FN_DECIMAL SingleCubicFractalBillow(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	FN_DECIMAL SingleCubicFractalRigidMulti(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
+	FN_DECIMAL SingleCubic(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
 
-	FN_DECIMAL SingleCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
-	FN_DECIMAL SingleCellular2Edge(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z);
+#if defined(__llvm__)
+	FN_DECIMAL SingleCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FastNoiseLookupCache* lookupCache = null) const;
+#else
+	FN_DECIMAL SingleCellular(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FastNoiseLookupCache* lookupCache = nullptr) const;
+#endif
+	FN_DECIMAL SingleCellular2Edge(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z) const;
 
-	void SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp, FN_DECIMAL frequency, FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z);
+	void SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp, FN_DECIMAL frequency, FN_DECIMAL& x, FN_DECIMAL& y, FN_DECIMAL& z) const;
 
 	//4D
-	FN_DECIMAL SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w);
+	FN_DECIMAL SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w) const;
+
+	//Grid
+	bool FillGrid2DSIMD(FN_DECIMAL* noiseOut, int x0, int y0, int width, int height, FN_DECIMAL step) const;
+	bool FillGrid3DSIMD(FN_DECIMAL* noiseOut, int x0, int y0, int z0, int width, int height, int depth, FN_DECIMAL step) const;
 private:
-	inline unsigned char Index2D_12(unsigned char offset, int x, int y);
-	inline unsigned char Index3D_12(unsigned char offset, int x, int y, int z);
-	inline unsigned char Index4D_32(unsigned char offset, int x, int y, int z, int w);
-	inline unsigned char Index2D_256(unsigned char offset, int x, int y);
-	inline unsigned char Index3D_256(unsigned char offset, int x, int y, int z);
-	inline unsigned char Index4D_256(unsigned char offset, int x, int y, int z, int w);
-
-	inline FN_DECIMAL ValCoord2DFast(unsigned char offset, int x, int y);
-	inline FN_DECIMAL ValCoord3DFast(unsigned char offset, int x, int y, int z);
-	inline FN_DECIMAL GradCoord2D(unsigned char offset, int x, int y, FN_DECIMAL xd, FN_DECIMAL yd);
-	inline FN_DECIMAL GradCoord3D(unsigned char offset, int x, int y, int z, FN_DECIMAL xd, FN_DECIMAL yd, FN_DECIMAL zd);
-	inline FN_DECIMAL GradCoord4D(unsigned char offset, int x, int y, int z, int w, FN_DECIMAL xd, FN_DECIMAL yd, FN_DECIMAL zd, FN_DECIMAL wd);
+	// Lane kernels used by FillGrid2D() and FillGrid3D(), defined in FastNoise.cpp
+	friend struct FastNoiseGrid;
+
+	inline unsigned char Index2D_12(unsigned char offset, int x, int y) const;
+	inline unsigned char Index3D_12(unsigned char offset, int x, int y, int z) const;
+	inline unsigned char Index4D_32(unsigned char offset, int x, int y, int z, int w) const;
+	inline unsigned char Index2D_256(unsigned char offset, int x, int y) const;
+	inline unsigned char Index3D_256(unsigned char offset, int x, int y, int z) const;
+	inline unsigned char Index4D_256(unsigned char offset, int x, int y, int z, int w) const;
+
+	inline FN_DECIMAL ValCoord2DFast(unsigned char offset, int x, int y) const;
+	inline FN_DECIMAL ValCoord3DFast(unsigned char offset, int x, int y, int z) const;
+	inline FN_DECIMAL GradCoord2D(unsigned char offset, int x, int y, FN_DECIMAL xd, FN_DECIMAL yd) const;
+	inline FN_DECIMAL GradCoord3D(unsigned char offset, int x, int y, int z, FN_DECIMAL xd, FN_DECIMAL yd, FN_DECIMAL zd) const;
+	inline FN_DECIMAL GradCoord4D(unsigned char offset, int x, int y, int z, int w, FN_DECIMAL xd, FN_DECIMAL yd, FN_DECIMAL zd, FN_DECIMAL wd) const;
+
+	// NoiseLookup value of cell (xc, yc[, zc]), memoized in lookupCache when there is one
+	FN_DECIMAL CellularLookup(int xc, int yc, FastNoiseLookupCache* lookupCache) const;
+	FN_DECIMAL CellularLookup(int xc, int yc, int zc, FastNoiseLookupCache* lookupCache) const;
 };
 #endif
@@ -0,0 +1,153 @@
+#include "gl_state.h"
+
+// Never a valid object name, marks a binding the cache doesn't know
+static const GLuint unknown = ~0u;
+
+static const GLenum bufferTargets[] = {GL_ARRAY_BUFFER,
+        GL_UNIFORM_BUFFER,
+        GL_PIXEL_PACK_BUFFER,
+        GL_PIXEL_UNPACK_BUFFER,
+        GL_COPY_READ_BUFFER,
+        GL_COPY_WRITE_BUFFER,
+        GL_TEXTURE_BUFFER};
+
+static const GLenum textureTargets[] = {GL_TEXTURE_2D,
+        GL_TEXTURE_3D,
+        GL_TEXTURE_2D_ARRAY,
+        GL_TEXTURE_CUBE_MAP,
+        GL_TEXTURE_1D};
+
+GLStateCache::GLStateCache() : issued(0), skipped(0) {
+    invalidate();
+}
+
+int GLStateCache::bufferSlot(GLenum target) {
+    for (int i = 0; i < bufferTargetCount; i++) {
+        if (bufferTargets[i] == target) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int GLStateCache::textureSlot(GLenum target) {
+    for (int i = 0; i < textureTargetCount; i++) {
+        if (textureTargets[i] == target) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void GLStateCache::useProgram(GLuint program) {
+    if (this->program == program) {
+        skipped++;
+        return;
+    }
+    glUseProgram(program);
+    this->program = program;
+    issued++;
+}
+
+void GLStateCache::bindVertexArray(GLuint vertexArray) {
+    if (this->vertexArray == vertexArray) {
+        skipped++;
+        return;
+    }
+    glBindVertexArray(vertexArray);
+    this->vertexArray = vertexArray;
+    issued++;
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer) {
+    int slot = bufferSlot(target);
+    if (slot >= 0 && buffers[slot] == buffer) {
+        skipped++;
+        return;
+    }
+    glBindBuffer(target, buffer);
+    if (slot >= 0) {
+        buffers[slot] = buffer;
+    }
+    issued++;
+}
+
+void GLStateCache::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+    int slot = textureSlot(target);
+    bool cached = slot >= 0 && unit < (GLuint)maxTextureUnits;
+    if (cached && textures[unit][slot] == texture) {
+        skipped++;
+        return;
+    }
+
+    GLenum textureUnit = GL_TEXTURE0 + unit;
+    if (activeUnit != textureUnit) {
+        glActiveTexture(textureUnit);
+        activeUnit = textureUnit;
+        issued++;
+    }
+    glBindTexture(target, texture);
+    if (cached) {
+        textures[unit][slot] = texture;
+    }
+    issued++;
+}
+
+void GLStateCache::invalidate() {
+    program = unknown;
+    vertexArray = unknown;
+    for (int i = 0; i < bufferTargetCount; i++) {
+        buffers[i] = unknown;
+    }
+    activeUnit = unknown;
+    for (int unit = 0; unit < maxTextureUnits; unit++) {
+        for (int i = 0; i < textureTargetCount; i++) {
+            textures[unit][i] = unknown;
+        }
+    }
+}
+
+void GLStateCache::deletedProgram(GLuint program) {
+    // A program in use stays current after glDeleteProgram, but its name
+    // may come back from glCreateProgram once it is released
+    if (this->program == program) {
+        this->program = unknown;
+    }
+}
+
+void GLStateCache::deletedVertexArray(GLuint vertexArray) {
+    if (this->vertexArray == vertexArray) {
+        this->vertexArray = 0;
+    }
+}
+
+void GLStateCache::deletedBuffer(GLuint buffer) {
+    for (int i = 0; i < bufferTargetCount; i++) {
+        if (buffers[i] == buffer) {
+            buffers[i] = 0;
+        }
+    }
+}
+
+void GLStateCache::deletedTexture(GLuint texture) {
+    for (int unit = 0; unit < maxTextureUnits; unit++) {
+        for (int i = 0; i < textureTargetCount; i++) {
+            if (textures[unit][i] == texture) {
+                textures[unit][i] = 0;
+            }
+        }
+    }
+}
+
+unsigned long GLStateCache::getIssued() const {
+    return issued;
+}
+
+unsigned long GLStateCache::getSkipped() const {
+    return skipped;
+}
+
+void GLStateCache::resetCounters() {
+    issued = 0;
+    skipped = 0;
+}
@@ -0,0 +1,55 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+// Shadows the bound program, VAO, buffers and textures of one context and
+// only calls into the driver when a binding actually changes. Every call
+// counts as issued or skipped.
+// The shadow starts out unknown, so the first bind of each slot is always
+// issued. Call invalidate() after code that binds things behind the cache's
+// back, and the deleted*() hooks when deleting objects that may be bound
+// (GL silently rebinds 0 then).
+class GLStateCache {
+  public:
+    static const int maxTextureUnits = 16;
+
+    GLStateCache();
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vertexArray);
+    // the element array binding lives in the VAO and is always issued
+    void bindBuffer(GLenum target, GLuint buffer);
+    // unit is 0 based (not GL_TEXTURE0 based), glActiveTexture is only
+    // issued when the texture binding itself has to change
+    void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+    // forget everything, the next binds are all issued
+    void invalidate();
+    void deletedProgram(GLuint program);
+    void deletedVertexArray(GLuint vertexArray);
+    void deletedBuffer(GLuint buffer);
+    void deletedTexture(GLuint texture);
+
+    unsigned long getIssued() const;
+    unsigned long getSkipped() const;
+    void resetCounters();
+
+  private:
+    // binding targets the cache knows about, anything else passes through
+    static const int bufferTargetCount = 7;
+    static const int textureTargetCount = 5;
+
+    static int bufferSlot(GLenum target);
+    static int textureSlot(GLenum target);
+
+    GLuint program;
+    GLuint vertexArray;
+    GLuint buffers[bufferTargetCount];
+    GLenum activeUnit;
+    GLuint textures[maxTextureUnits][textureTargetCount];
+
+    unsigned long issued;
+    unsigned long skipped;
+};
+#endif
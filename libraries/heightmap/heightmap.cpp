@@ -0,0 +1,183 @@
+#include "heightmap.h"
+
+HeightmapGenerator::HeightmapGenerator(JobSystem& jobSystem, int tileSize)
+        : jobSystem(jobSystem), tileSize(tileSize > 0 ? tileSize : 64) {
+}
+
+int HeightmapGenerator::getTileSize() const {
+    return tileSize;
+}
+
+HeightRange HeightmapGenerator::generate(const FastNoise& noise,
+        float* heightMap,
+        int mapWidth,
+        int mapHeight,
+        int step,
+        const std::atomic<unsigned int>* generation,
+        unsigned int expected) {
+    return generateWindow(noise,
+            heightMap,
+            0,
+            0,
+            mapWidth,
+            mapHeight,
+            step,
+            generation,
+            expected);
+}
+
+HeightRange HeightmapGenerator::generateWindow(const FastNoise& noise,
+        float* heightMap,
+        int originX,
+        int originY,
+        int mapWidth,
+        int mapHeight,
+        int step,
+        const std::atomic<unsigned int>* generation,
+        unsigned int expected) {
+    int tilesX = (mapWidth + tileSize - 1) / tileSize;
+    int tilesY = (mapHeight + tileSize - 1) / tileSize;
+    tileRanges.resize((size_t)(tilesX * tilesY));
+
+    for (int tileY = 0; tileY < mapHeight; tileY += tileSize) {
+        for (int tileX = 0; tileX < mapWidth; tileX += tileSize) {
+            int width = mapWidth - tileX < tileSize ? mapWidth - tileX
+                                                    : tileSize;
+            int height = mapHeight - tileY < tileSize ? mapHeight - tileY
+                                                      : tileSize;
+
+            const FastNoise* tileNoise = &noise;
+            HeightRange* tileRange = &tileRanges[(size_t)(
+                    (tileY / tileSize) * tilesX + (tileX / tileSize))];
+            jobSystem.submit([=] {
+                if (generation != nullptr && *generation != expected) {
+                    tileRange->min = 0.0f;
+                    tileRange->max = 0.0f;
+                    return;
+                }
+
+                // Map rows run along the noise's x axis, so the tile is
+                // filled column by column and transposed into the map
+                std::vector<float> columns((size_t)(width * height));
+                tileNoise->FillGrid2D(&columns[0],
+                        originY + tileY * step,
+                        originX + tileX * step,
+                        height,
+                        width,
+                        (FN_DECIMAL)step);
+
+                float min = columns[0];
+                float max = min;
+                for (int y = 0; y < height; y++) {
+                    float* row = heightMap + ((tileY + y) * mapWidth) + tileX;
+                    for (int x = 0; x < width; x++) {
+                        float value = columns[(size_t)(x * height + y)];
+                        row[x] = value;
+                        min = value < min ? value : min;
+                        max = value > max ? value : max;
+                    }
+                }
+                tileRange->min = min;
+                tileRange->max = max;
+            });
+        }
+    }
+    jobSystem.wait();
+
+    HeightRange range = tileRanges[0];
+    for (size_t i = 1; i < tileRanges.size(); i++) {
+        range.min = tileRanges[i].min < range.min ? tileRanges[i].min
+                                                  : range.min;
+        range.max = tileRanges[i].max > range.max ? tileRanges[i].max
+                                                  : range.max;
+    }
+    return range;
+}
+
+// Branch free so the single channel case vectorizes
+template<typename T>
+static void quantizeRow(const float* in,
+        T* out,
+        int count,
+        int channels,
+        float scale,
+        float bias,
+        float top) {
+    if (channels == 1) {
+        for (int i = 0; i < count; i++) {
+            float value = (in[i] * scale) + bias;
+            value = value < 0.0f ? 0.0f : value;
+            value = value > top ? top : value;
+            out[i] = (T)value;
+        }
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        float value = (in[i] * scale) + bias;
+        value = value < 0.0f ? 0.0f : value;
+        value = value > top ? top : value;
+        for (int c = 0; c < channels; c++) {
+            out[(i * channels) + c] = (T)value;
+        }
+    }
+}
+
+template<typename T>
+void HeightmapGenerator::quantizeRows(const float* heightMap,
+        int mapWidth,
+        int mapHeight,
+        HeightRange range,
+        T* out,
+        int channels,
+        float top) {
+    // A flat map has nothing to stretch, map it to black
+    float scale = range.max > range.min ? top / (range.max - range.min)
+                                        : 0.0f;
+    float bias = -range.min * scale;
+
+    for (int bandY = 0; bandY < mapHeight; bandY += tileSize) {
+        int height = mapHeight - bandY < tileSize ? mapHeight - bandY
+                                                  : tileSize;
+        jobSystem.submit([=] {
+            for (int y = bandY; y < bandY + height; y++) {
+                quantizeRow(heightMap + (y * mapWidth),
+                        out + (y * mapWidth * channels),
+                        mapWidth,
+                        channels,
+                        scale,
+                        bias,
+                        top);
+            }
+        });
+    }
+    jobSystem.wait();
+}
+
+void HeightmapGenerator::quantize(const float* heightMap,
+        int mapWidth,
+        int mapHeight,
+        HeightRange range,
+        unsigned char* out,
+        int channels) {
+    quantizeRows(heightMap, mapWidth, mapHeight, range, out, channels, 255.0f);
+}
+
+void HeightmapGenerator::quantize(const float* heightMap,
+        int mapWidth,
+        int mapHeight,
+        HeightRange range,
+        unsigned short* out,
+        int channels) {
+    quantizeRows(
+            heightMap, mapWidth, mapHeight, range, out, channels, 65535.0f);
+}
+
+void HeightmapGenerator::quantize(const float* heightMap,
+        int mapWidth,
+        int mapHeight,
+        HeightRange range,
+        float* out,
+        int channels) {
+    quantizeRows(heightMap, mapWidth, mapHeight, range, out, channels, 1.0f);
+}
@@ -0,0 +1,95 @@
+#ifndef HEIGHTMAP_H
+#define HEIGHTMAP_H
+
+#include <FastNoise.h>
+#include <job_system.h>
+
+#include <atomic>
+#include <vector>
+
+// Lowest and highest sample of a generated heightmap
+struct HeightRange {
+    float min;
+    float max;
+};
+
+// Splits a heightmap into square tiles and fills them in parallel on a
+// JobSystem. Every texel is sampled at its own map coordinates, so the
+// result is the same whatever the thread count or tile size.
+class HeightmapGenerator {
+  public:
+    // tileSize is in texels, 64 * 64 floats (16 KiB) stays in L1/L2
+    explicit HeightmapGenerator(JobSystem& jobSystem, int tileSize = 64);
+
+    int getTileSize() const;
+
+    // Fills heightMap (mapWidth * mapHeight floats, row major) with
+    // noise.GetNoise(y * step, x * step) and blocks until every tile is done.
+    // Rows run along the noise's x axis, like the original per texel loops.
+    // A step above 1 gives a downsampled preview whose samples are a subset
+    // of the full resolution ones. The noise object is shared read-only by
+    // all the workers.
+    // The range is reduced per tile while the tile is still in cache, so
+    // no separate min/max pass over the map is needed.
+    // If generation is given, tiles that start after it has moved on from
+    // expected are skipped, and the map and range are left incomplete.
+    HeightRange generate(const FastNoise& noise,
+            float* heightMap,
+            int mapWidth,
+            int mapHeight,
+            int step = 1,
+            const std::atomic<unsigned int>* generation = nullptr,
+            unsigned int expected = 0);
+    // Same for the window whose top left sample is at (originX, originY),
+    // sample (x, y) is noise.GetNoise(originY + y * step, originX + x * step).
+    // Noise only depends on position, so windows generated separately line
+    // up texel for texel with one generated whole (strips of a panned view).
+    HeightRange generateWindow(const FastNoise& noise,
+            float* heightMap,
+            int originX,
+            int originY,
+            int mapWidth,
+            int mapHeight,
+            int step = 1,
+            const std::atomic<unsigned int>* generation = nullptr,
+            unsigned int expected = 0);
+
+    // Remaps range to 0..255 and writes each height to channels
+    // consecutive bytes of out (1 for GL_RED, 3 for grey GL_RGB), in one
+    // pass split into row bands over the workers.
+    void quantize(const float* heightMap,
+            int mapWidth,
+            int mapHeight,
+            HeightRange range,
+            unsigned char* out,
+            int channels = 1);
+    // Same, remapped to 0..65535 for GL_R16
+    void quantize(const float* heightMap,
+            int mapWidth,
+            int mapHeight,
+            HeightRange range,
+            unsigned short* out,
+            int channels = 1);
+    // Same, remapped to 0..1 for GL_R32F
+    void quantize(const float* heightMap,
+            int mapWidth,
+            int mapHeight,
+            HeightRange range,
+            float* out,
+            int channels = 1);
+
+  private:
+    template<typename T>
+    void quantizeRows(const float* heightMap,
+            int mapWidth,
+            int mapHeight,
+            HeightRange range,
+            T* out,
+            int channels,
+            float top);
+
+    JobSystem& jobSystem;
+    int tileSize;
+    std::vector<HeightRange> tileRanges;
+};
+#endif
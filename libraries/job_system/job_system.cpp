@@ -0,0 +1,133 @@
+#include "job_system.h"
+
+JobSystem::JobSystem(unsigned int threadCount)
+        : nextQueue(0), queuedJobs(0), pendingJobs(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+
+    for (unsigned int i = 0; i < threadCount; i++) {
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+    for (unsigned int i = 0; i < threadCount; i++) {
+        workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+    }
+}
+
+JobSystem::~JobSystem() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+unsigned int JobSystem::getThreadCount() const {
+    return (unsigned int)workers.size();
+}
+
+void JobSystem::submit(const Job& job) {
+    unsigned int queueIndex = nextQueue++ % (unsigned int)queues.size();
+
+    pendingJobs++;
+    {
+        std::lock_guard<std::mutex> lock(queues[queueIndex]->mutex);
+        queues[queueIndex]->jobs.push_back(job);
+    }
+    {
+        // under the wake mutex so a worker can't miss it between checking
+        // the counter and going to sleep
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        queuedJobs++;
+    }
+    wakeCondition.notify_one();
+}
+
+void JobSystem::wait() {
+    Job job;
+    unsigned int queueIndex = nextQueue % (unsigned int)queues.size();
+    while (popJob(queueIndex, job)) {
+        job();
+        finishJob();
+    }
+
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    doneCondition.wait(lock, [this] { return pendingJobs == 0; });
+}
+
+void JobSystem::parallelFor(size_t count,
+        size_t chunkSize,
+        const RangeJob& job) {
+    if (chunkSize == 0) {
+        size_t chunks = (size_t)getThreadCount() * 4;
+        chunkSize = (count + chunks - 1) / chunks;
+    }
+    if (count <= chunkSize) {
+        // Not worth a trip through the queues
+        if (count > 0) {
+            job(0, count);
+        }
+        return;
+    }
+
+    const RangeJob* range = &job;
+    for (size_t begin = 0; begin < count; begin += chunkSize) {
+        size_t end = count - begin < chunkSize ? count : begin + chunkSize;
+        submit([=] { (*range)(begin, end); });
+    }
+    wait();
+}
+
+void JobSystem::workerLoop(unsigned int queueIndex) {
+    Job job;
+    while (true) {
+        if (popJob(queueIndex, job)) {
+            job();
+            finishJob();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(
+                lock, [this] { return stopping || queuedJobs > 0; });
+        if (stopping && queuedJobs == 0) {
+            return;
+        }
+    }
+}
+
+bool JobSystem::popJob(unsigned int queueIndex, Job& job) {
+    unsigned int queueCount = (unsigned int)queues.size();
+    for (unsigned int i = 0; i < queueCount; i++) {
+        WorkQueue& queue = *queues[(queueIndex + i) % queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) {
+            continue;
+        }
+
+        if (i == 0) {
+            job = queue.jobs.back();
+            queue.jobs.pop_back();
+        } else {
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+        }
+        queuedJobs--;
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::finishJob() {
+    if (--pendingJobs == 0) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        doneCondition.notify_all();
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads. Every worker owns a queue, submitted jobs are
+// spread over the queues round robin and idle workers steal from the others.
+class JobSystem {
+  public:
+    typedef std::function<void()> Job;
+    typedef std::function<void(size_t begin, size_t end)> RangeJob;
+
+    // threadCount of 0 uses one worker per hardware thread
+    explicit JobSystem(unsigned int threadCount = 0);
+    ~JobSystem();
+
+    unsigned int getThreadCount() const;
+
+    // queue a job, it may start running before submit() returns
+    void submit(const Job& job);
+    // run queued jobs on the calling thread until every submitted job is done
+    void wait();
+    // splits [0, count) into chunks of chunkSize indices (0 picks about four
+    // chunks per worker), runs job on each chunk and waits like wait(). The
+    // calling thread works on chunks too. Not to be called from a job.
+    void parallelFor(size_t count, size_t chunkSize, const RangeJob& job);
+
+  private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void workerLoop(unsigned int queueIndex);
+    // pops from the back of its own queue, then steals from the front of
+    // the others
+    bool popJob(unsigned int queueIndex, Job& job);
+    void finishJob();
+
+    std::vector<std::unique_ptr<WorkQueue> > queues;
+    std::vector<std::thread> workers;
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+
+    std::atomic<unsigned int> nextQueue;
+    std::atomic<int> queuedJobs;
+    std::atomic<int> pendingJobs;
+    bool stopping;
+};
+#endif
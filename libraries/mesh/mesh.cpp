@@ -0,0 +1,261 @@
+#include "mesh.h"
+
+#include <gl_state.h>
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+// Round to nearest even, overflow goes to infinity and tiny values to
+// half denormals or zero
+static unsigned short floatToHalf(float value) {
+    unsigned int bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    unsigned int sign = (bits >> 16) & 0x8000u;
+    unsigned int exponent = (bits >> 23) & 0xffu;
+    unsigned int mantissa = bits & 0x7fffffu;
+
+    if (exponent == 0xffu) {
+        // infinity, or a quiet NaN
+        return (unsigned short)(sign | 0x7c00u | (mantissa ? 0x200u : 0u));
+    }
+    int halfExponent = (int)exponent - 127 + 15;
+    if (halfExponent >= 31) {
+        return (unsigned short)(sign | 0x7c00u);
+    }
+
+    unsigned int half;
+    unsigned int rest;
+    unsigned int halfway;
+    if (halfExponent <= 0) {
+        if (halfExponent < -10) {
+            return (unsigned short)sign;
+        }
+        mantissa |= 0x800000u;
+        unsigned int shift = (unsigned int)(14 - halfExponent);
+        half = mantissa >> shift;
+        rest = mantissa & ((1u << shift) - 1u);
+        halfway = 1u << (shift - 1u);
+    } else {
+        half = ((unsigned int)halfExponent << 10) | (mantissa >> 13);
+        rest = mantissa & 0x1fffu;
+        halfway = 0x1000u;
+    }
+    // a carry out of the mantissa correctly bumps the exponent
+    if (rest > halfway || (rest == halfway && (half & 1u))) {
+        half++;
+    }
+    return (unsigned short)(sign | half);
+}
+
+// Attributes start on 4 byte boundaries, a 3 component half or short
+// attribute takes 8 bytes
+static GLsizei alignedSize(size_t size) {
+    return (GLsizei)((size + 3) & ~(size_t)3);
+}
+
+Mesh::Mesh(const float* vertices,
+        size_t vertexCount,
+        const std::vector<int>& layout,
+        Packing packing)
+        : stride(0),
+          indexType(GL_UNSIGNED_SHORT),
+          indexCount(vertexCount),
+          VAO(0),
+          VBO(0),
+          EBO(0) {
+    size_t floatsPerVertex = 0;
+    for (size_t i = 0; i < layout.size(); i++) {
+        floatsPerVertex += (size_t)layout[i];
+    }
+
+    // Describe the packed attributes
+    size_t first = 0;
+    for (size_t i = 0; i < layout.size(); i++) {
+        MeshAttribute attribute;
+        attribute.components = layout[i];
+        attribute.offset = stride;
+        attribute.scale = 1.0f;
+
+        if (packing == Float) {
+            attribute.type = GL_FLOAT;
+            attribute.normalized = GL_FALSE;
+        } else if (packing == HalfFloat) {
+            attribute.type = GL_HALF_FLOAT;
+            attribute.normalized = GL_FALSE;
+        } else {
+            // Unsigned when nothing is negative, so 0 and 1 (uvs) stay exact
+            float maxAbs = 0.0f;
+            bool negative = false;
+            for (size_t v = 0; v < vertexCount; v++) {
+                const float* values = vertices + v * floatsPerVertex + first;
+                for (int c = 0; c < layout[i]; c++) {
+                    maxAbs = std::fmax(maxAbs, std::fabs(values[c]));
+                    negative = negative || values[c] < 0.0f;
+                }
+            }
+            attribute.type = negative ? GL_SHORT : GL_UNSIGNED_SHORT;
+            attribute.normalized = GL_TRUE;
+            attribute.scale = maxAbs > 1.0f ? maxAbs : 1.0f;
+        }
+
+        size_t componentSize = packing == Float ? sizeof(float) : 2;
+        stride += alignedSize((size_t)layout[i] * componentSize);
+        attributes.push_back(attribute);
+        first += (size_t)layout[i];
+    }
+
+    // Pack each vertex, then merge the ones whose packed bytes match. Bytes
+    // rather than floats so that vertices equal after packing merge too.
+    std::vector<unsigned char> packed((size_t)stride);
+    std::unordered_map<std::string, unsigned int> unique;
+    std::vector<unsigned int> indices(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        std::memset(&packed[0], 0, packed.size());
+        const float* values = vertices + v * floatsPerVertex;
+        for (size_t i = 0; i < attributes.size(); i++) {
+            const MeshAttribute& attribute = attributes[i];
+            unsigned char* out = &packed[(size_t)attribute.offset];
+            for (int c = 0; c < attribute.components; c++) {
+                float value = *values++;
+                if (attribute.type == GL_FLOAT) {
+                    std::memcpy(out + c * 4, &value, 4);
+                } else if (attribute.type == GL_HALF_FLOAT) {
+                    unsigned short half = floatToHalf(value);
+                    std::memcpy(out + c * 2, &half, 2);
+                } else if (attribute.type == GL_SHORT) {
+                    short normalized = (short)std::lround(
+                            value / attribute.scale * 32767.0f);
+                    std::memcpy(out + c * 2, &normalized, 2);
+                } else {
+                    unsigned short normalized = (unsigned short)std::lround(
+                            value / attribute.scale * 65535.0f);
+                    std::memcpy(out + c * 2, &normalized, 2);
+                }
+            }
+        }
+
+        std::string key(packed.begin(), packed.end());
+        std::unordered_map<std::string, unsigned int>::iterator found =
+                unique.find(key);
+        if (found == unique.end()) {
+            unsigned int index = (unsigned int)unique.size();
+            unique[key] = index;
+            vertexData.insert(vertexData.end(), packed.begin(), packed.end());
+            indices[v] = index;
+        } else {
+            indices[v] = found->second;
+        }
+    }
+
+    if (unique.size() > 65536) {
+        indexType = GL_UNSIGNED_INT;
+        indexData.resize(indexCount * sizeof(unsigned int));
+        std::memcpy(&indexData[0], &indices[0], indexData.size());
+    } else {
+        indexData.resize(indexCount * sizeof(unsigned short));
+        for (size_t i = 0; i < indexCount; i++) {
+            unsigned short index = (unsigned short)indices[i];
+            std::memcpy(&indexData[i * sizeof(index)], &index, sizeof(index));
+        }
+    }
+}
+
+void Mesh::upload() {
+    if (VAO == 0) {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+    }
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER,
+            (GLsizeiptr)vertexData.size(),
+            vertexData.empty() ? NULL : &vertexData[0],
+            GL_STATIC_DRAW);
+    // The element buffer binding is part of the VAO
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+            (GLsizeiptr)indexData.size(),
+            indexData.empty() ? NULL : &indexData[0],
+            GL_STATIC_DRAW);
+
+    for (size_t i = 0; i < attributes.size(); i++) {
+        const MeshAttribute& attribute = attributes[i];
+        glVertexAttribPointer((GLuint)i,
+                attribute.components,
+                attribute.type,
+                attribute.normalized,
+                stride,
+                (void*)(size_t)attribute.offset);
+        glEnableVertexAttribArray((GLuint)i);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Mesh::release() {
+    if (VAO != 0) {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        VAO = 0;
+        VBO = 0;
+        EBO = 0;
+    }
+}
+
+void Mesh::draw() const {
+    glBindVertexArray(VAO);
+    glDrawElements(GL_TRIANGLES, (GLsizei)indexCount, indexType, (void*)0);
+}
+
+void Mesh::drawInstanced(GLsizei instanceCount) const {
+    glBindVertexArray(VAO);
+    glDrawElementsInstanced(GL_TRIANGLES,
+            (GLsizei)indexCount,
+            indexType,
+            (void*)0,
+            instanceCount);
+}
+
+void Mesh::draw(GLStateCache& state) const {
+    state.bindVertexArray(VAO);
+    glDrawElements(GL_TRIANGLES, (GLsizei)indexCount, indexType, (void*)0);
+}
+
+void Mesh::drawInstanced(GLStateCache& state, GLsizei instanceCount) const {
+    state.bindVertexArray(VAO);
+    glDrawElementsInstanced(GL_TRIANGLES,
+            (GLsizei)indexCount,
+            indexType,
+            (void*)0,
+            instanceCount);
+}
+
+unsigned int Mesh::getVAO() const {
+    return VAO;
+}
+
+size_t Mesh::getVertexCount() const {
+    return stride > 0 ? vertexData.size() / (size_t)stride : 0;
+}
+
+size_t Mesh::getIndexCount() const {
+    return indexCount;
+}
+
+GLsizei Mesh::getStride() const {
+    return stride;
+}
+
+const std::vector<MeshAttribute>& Mesh::getAttributes() const {
+    return attributes;
+}
+
+size_t Mesh::getByteSize() const {
+    return vertexData.size() + indexData.size();
+}
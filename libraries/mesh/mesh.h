@@ -0,0 +1,81 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+class GLStateCache;
+
+// One attribute of a packed vertex, as passed to glVertexAttribPointer
+struct MeshAttribute {
+    GLint components;
+    GLenum type;
+    GLboolean normalized;
+    GLsizei offset;
+    // normalized shorts only hold [-1, 1] (or [0, 1]), the shader multiplies
+    // the fetched value by scale to get the source value back. 1 otherwise.
+    float scale;
+};
+
+// Indexed mesh built from an unindexed, interleaved float array like the
+// demos' vertices[]. Identical vertices are merged into an index buffer and
+// the attributes can be packed into 16 bit types to cut vertex fetch.
+class Mesh {
+  public:
+    enum Packing {
+        // 32 bit floats, as given
+        Float,
+        // GL_HALF_FLOAT, about 3 significant digits
+        HalfFloat,
+        // GL_SHORT / GL_UNSIGNED_SHORT normalized, scaled per attribute
+        NormalizedShort
+    };
+
+    // vertices holds vertexCount vertices, each made of the attributes in
+    // layout one after the other, e.g. {3, 2} for a position and a uv.
+    // Only builds the CPU side, no GL context is needed until upload().
+    Mesh(const float* vertices,
+            size_t vertexCount,
+            const std::vector<int>& layout,
+            Packing packing = Float);
+
+    // creates the buffers and a VAO with attribute i at location i. The VAO
+    // is left unbound, bind getVAO() to add per-instance attributes.
+    void upload();
+    // deletes the GL objects, call it while the context is still current
+    void release();
+    // glDrawElements / glDrawElementsInstanced with the mesh's VAO
+    void draw() const;
+    void drawInstanced(GLsizei instanceCount) const;
+    // same, the VAO is bound through the cache
+    void draw(GLStateCache& state) const;
+    void drawInstanced(GLStateCache& state, GLsizei instanceCount) const;
+
+    unsigned int getVAO() const;
+    // unique vertices after merging
+    size_t getVertexCount() const;
+    size_t getIndexCount() const;
+    GLsizei getStride() const;
+    const std::vector<MeshAttribute>& getAttributes() const;
+    // vertex plus index bytes sent to the GPU
+    size_t getByteSize() const;
+
+  private:
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    std::vector<MeshAttribute> attributes;
+    GLsizei stride;
+    std::vector<unsigned char> vertexData;
+    // GL_UNSIGNED_SHORT while there are at most 65536 vertices
+    GLenum indexType;
+    std::vector<unsigned char> indexData;
+    size_t indexCount;
+
+    unsigned int VAO;
+    unsigned int VBO;
+    unsigned int EBO;
+};
+#endif
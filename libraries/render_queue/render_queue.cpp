@@ -0,0 +1,76 @@
+#include "render_queue.h"
+
+#include <algorithm>
+#include <cstring>
+
+RenderQueue::RenderQueue(GLStateCache& state) : state(state) {
+}
+
+uint64_t RenderQueue::makeKey(unsigned int program,
+        unsigned int material,
+        unsigned int mesh) {
+    return ((uint64_t)(program & 0xffffu) << 48) |
+           ((uint64_t)(material & 0xffffffu) << 24) |
+           (uint64_t)(mesh & 0xffffffu);
+}
+
+unsigned int RenderQueue::intern(
+        std::unordered_map<const void*, unsigned int>& ids,
+        const void* object) {
+    std::unordered_map<const void*, unsigned int>::iterator found =
+            ids.find(object);
+    if (found != ids.end()) {
+        return found->second;
+    }
+    unsigned int id = (unsigned int)ids.size();
+    ids[object] = id;
+    return id;
+}
+
+void RenderQueue::submit(Shader& shader,
+        const RenderMaterial& material,
+        const Mesh& mesh,
+        UniformHandle modelUniform,
+        const GLfloat* model) {
+    DrawPacket packet;
+    packet.shader = &shader;
+    packet.material = &material;
+    packet.mesh = &mesh;
+    packet.modelUniform = modelUniform;
+    std::memcpy(packet.model, model, sizeof(packet.model));
+
+    uint64_t key = makeKey(intern(programIDs, &shader),
+            intern(materialIDs, &material),
+            intern(meshIDs, &mesh));
+    order.push_back(std::make_pair(key, (unsigned int)packets.size()));
+    packets.push_back(packet);
+}
+
+void RenderQueue::flush() {
+    // Ties keep submission order
+    std::sort(order.begin(), order.end());
+
+    for (size_t i = 0; i < order.size(); i++) {
+        const DrawPacket& packet = packets[order[i].second];
+
+        packet.shader->use(state);
+        const RenderMaterial& material = *packet.material;
+        for (int unit = 0; unit < material.textureCount; unit++) {
+            state.bindTexture(
+                    (GLuint)unit, material.target, material.textures[unit]);
+        }
+        packet.shader->setMat4(packet.modelUniform, packet.model);
+        packet.mesh->draw(state);
+    }
+
+    packets.clear();
+    order.clear();
+    // Objects may not outlive the frame, so neither may their ids
+    programIDs.clear();
+    materialIDs.clear();
+    meshIDs.clear();
+}
+
+size_t RenderQueue::getSize() const {
+    return packets.size();
+}
@@ -0,0 +1,75 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <gl_state.h>
+#include <glad/glad.h>
+#include <mesh.h>
+#include <shader.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Textures bound to units 0, 1, ... for a draw
+struct RenderMaterial {
+    static const int maxTextures = 4;
+
+    GLenum target;
+    GLuint textures[maxTextures];
+    int textureCount;
+
+    RenderMaterial() : target(GL_TEXTURE_2D), textures(), textureCount(0) {
+    }
+};
+
+// Everything needed for one draw. The model matrix is copied, the shader,
+// material and mesh must live until the queue is flushed.
+struct DrawPacket {
+    Shader* shader;
+    const RenderMaterial* material;
+    const Mesh* mesh;
+    UniformHandle modelUniform;
+    GLfloat model[16];
+};
+
+// Collects draw packets for a frame, then sorts them by a 64 bit key and
+// draws them in one pass through a GLStateCache, so packets sharing a
+// program, material or mesh end up next to each other and their binds are
+// skipped.
+// Key, most significant first: program (16 bits), material (24 bits),
+// mesh (24 bits). Each is a dense index handed out in order of first
+// submission.
+class RenderQueue {
+  public:
+    explicit RenderQueue(GLStateCache& state);
+
+    void submit(Shader& shader,
+            const RenderMaterial& material,
+            const Mesh& mesh,
+            UniformHandle modelUniform,
+            const GLfloat* model);
+    // sorts and draws everything submitted since the last flush, then
+    // empties the queue
+    void flush();
+
+    size_t getSize() const;
+
+  private:
+    static uint64_t makeKey(unsigned int program,
+            unsigned int material,
+            unsigned int mesh);
+    static unsigned int intern(
+            std::unordered_map<const void*, unsigned int>& ids,
+            const void* object);
+
+    GLStateCache& state;
+    std::vector<DrawPacket> packets;
+    // key and index into packets, sorted in place of the packets themselves
+    std::vector<std::pair<uint64_t, unsigned int>> order;
+
+    std::unordered_map<const void*, unsigned int> programIDs;
+    std::unordered_map<const void*, unsigned int> materialIDs;
+    std::unordered_map<const void*, unsigned int> meshIDs;
+};
+#endif
@@ -1,9 +1,37 @@
 #include "shader.h"
 
-Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath) {
-    // 1. retrieve the vertex/fragment source code from file paths
+#include <gl_state.h>
+
+#include "shader_watcher.h"
+
+#include <random>
+
+#ifdef SHADER_CACHE_DIR
+std::string Shader::binaryCacheDirectory = SHADER_CACHE_DIR;
+#else
+std::string Shader::binaryCacheDirectory;
+#endif
+
+void Shader::setBinaryCacheDirectory(const std::string& directory) {
+    binaryCacheDirectory = directory;
+}
+
+Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath)
+        : vertexPath(vertexPath), fragmentPath(fragmentPath) {
     std::string vertexCode;
     std::string fragmentCode;
+    readSources(vertexCode, fragmentCode);
+    // a program that failed to build is kept, its errors are already printed
+    buildProgram(vertexCode, fragmentCode, this->programID);
+    cacheUniforms();
+}
+
+// Out of line so the header only needs a declaration of ShaderWatcher
+Shader::~Shader() {
+}
+
+bool Shader::readSources(std::string& vertexCode, std::string& fragmentCode) {
+    // 1. retrieve the vertex/fragment source code from file paths
     std::ifstream vShaderFile;
     std::ifstream fShaderFile;
     // ensure ifstream obj can throw exceptions
@@ -12,8 +40,8 @@ Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath) {
 
     try {
         // open files
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
+        vShaderFile.open(vertexPath.c_str());
+        fShaderFile.open(fragmentPath.c_str());
         std::stringstream vShaderStream, fShaderStream;
         // read file's buffer contents into streams
         vShaderStream << vShaderFile.rdbuf();
@@ -26,13 +54,25 @@ Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath) {
         fragmentCode = fShaderStream.str();
     } catch (std::ifstream::failure e) {
         std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+        return false;
     }
+    return true;
+}
+
+bool Shader::buildProgram(const std::string& vertexCode,
+        const std::string& fragmentCode,
+        unsigned int& program) {
+    std::string cachePath = binaryCachePath(vertexCode, fragmentCode);
+    if (!cachePath.empty() && loadProgramBinary(cachePath, program)) {
+        return true;
+    }
+
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
 
     // 2. compile and link the shaders
     unsigned int vertex, fragment;
-    int success;
+    int success, compiled = 1;
     char infoLog[512];
 
     // vertex shader
@@ -44,6 +84,7 @@ Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath) {
         glGetShaderInfoLog(vertex, 512, NULL, infoLog);
         std::cerr << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n\t" << infoLog
                   << std::endl;
+        compiled = 0;
     }
 
     // fragment shader
@@ -55,37 +96,314 @@ Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath) {
         glGetShaderInfoLog(fragment, 512, NULL, infoLog);
         std::cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n\t"
                   << infoLog << std::endl;
+        compiled = 0;
     }
 
     // shader program
-    this->programID = glCreateProgram();
-    glAttachShader(this->programID, vertex);
-    glAttachShader(this->programID, fragment);
-    glLinkProgram(this->programID);
-    glGetProgramiv(this->programID, GL_LINK_STATUS, &success);
+    program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    if (!cachePath.empty()) {
+        glProgramParameteri(
+                program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success) {
-        glGetProgramInfoLog(this->programID, 512, NULL, infoLog);
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
         std::cerr << "ERROR::SHADER::PROGRAM::COMPILATION_FAILED\n\t" << infoLog
                   << std::endl;
+    } else if (!cachePath.empty()) {
+        saveProgramBinary(program, cachePath);
     }
 
     // delete these two as they are linked and no longer needed
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+
+    return compiled && success;
+}
+
+void Shader::watch() {
+    if (!watcher) {
+        std::vector<std::string> paths;
+        paths.push_back(vertexPath);
+        paths.push_back(fragmentPath);
+        watcher.reset(new ShaderWatcher(paths));
+    }
+}
+
+bool Shader::reloadIfChanged() {
+    if (!watcher || !watcher->poll()) {
+        return false;
+    }
+    return reload();
+}
+
+bool Shader::reload() {
+    return rebuild(NULL);
+}
+
+bool Shader::reloadIfChanged(GLStateCache& state) {
+    if (!watcher || !watcher->poll()) {
+        return false;
+    }
+    return reload(state);
+}
+
+bool Shader::reload(GLStateCache& state) {
+    return rebuild(&state);
+}
+
+bool Shader::rebuild(GLStateCache* state) {
+    std::string vertexCode;
+    std::string fragmentCode;
+    if (!readSources(vertexCode, fragmentCode)) {
+        return false;
+    }
+
+    unsigned int program;
+    if (!buildProgram(vertexCode, fragmentCode, program)) {
+        glDeleteProgram(program);
+        std::cerr << "ERROR::SHADER::RELOAD_FAILED keeping the previous program"
+                  << std::endl;
+        return false;
+    }
+
+    // swap, keeping the program bound if the old one was. The cache has to
+    // forget the old name, the driver may hand it out again.
+    GLint current = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+    glDeleteProgram(this->programID);
+    if (state != NULL) {
+        state->deletedProgram(this->programID);
+    }
+    if ((unsigned int)current == this->programID) {
+        if (state != NULL) {
+            state->useProgram(program);
+        } else {
+            glUseProgram(program);
+        }
+    }
+    this->programID = program;
+    cacheUniforms();
+    return true;
+}
+
+// Cache file for this pair of sources on this driver, or "" when the cache
+// is off or the driver can't hand out program binaries. The name is a 64 bit
+// FNV-1a hash of both sources and the vendor, renderer and version strings,
+// so a driver update or an edited shader simply misses.
+std::string Shader::binaryCachePath(
+        const std::string& vertexCode, const std::string& fragmentCode) {
+    if (binaryCacheDirectory.empty() || !GLAD_GL_ARB_get_program_binary) {
+        return "";
+    }
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        return "";
+    }
+
+    const GLubyte* driver[] = {glGetString(GL_VENDOR),
+            glGetString(GL_RENDERER),
+            glGetString(GL_VERSION)};
+    std::string key = vertexCode + '\0' + fragmentCode;
+    for (int i = 0; i < 3; i++) {
+        key += '\0';
+        if (driver[i] != NULL) {
+            key += (const char*)driver[i];
+        }
+    }
+
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < key.size(); i++) {
+        hash ^= (unsigned char)key[i];
+        hash *= 1099511628211ULL;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", hash);
+    return binaryCacheDirectory + "/" + name;
+}
+
+// The file holds the binary format followed by the binary itself
+bool Shader::loadProgramBinary(const std::string& path, unsigned int& program) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    GLenum format = 0;
+    file.read((char*)&format, sizeof(format));
+    if (file.gcount() != sizeof(format)) {
+        return false;
+    }
+    std::string binary((std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>());
+    if (binary.empty()) {
+        return false;
+    }
+
+    program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), (GLsizei)binary.size());
+
+    // the driver may still reject it, then build from source as usual
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(program);
+        return false;
+    }
+    return true;
+}
+
+void Shader::saveProgramBinary(unsigned int program, const std::string& path) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    std::string binary((size_t)length, '\0');
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, &binary[0]);
+
+    // Written next to the target and renamed over it, so a crash or another
+    // instance saving the same program never leaves a truncated file behind
+    std::string temporary =
+            path + "." + std::to_string(std::random_device()()) + ".tmp";
+    {
+        std::ofstream file(
+                temporary.c_str(), std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return; // missing or read-only cache directory, not worth a warning
+        }
+        file.write((const char*)&format, sizeof(format));
+        file.write(binary.data(), length);
+        if (!file.flush()) {
+            file.close();
+            std::remove(temporary.c_str());
+            return;
+        }
+    }
+    // Fails on Windows when the target exists, another process wrote it then
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+    }
+}
+
+void Shader::cacheUniforms() {
+    uniformLocations.clear();
+
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    if (count <= 0) {
+        return;
+    }
+
+    std::string name((size_t)maxLength, '\0');
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type;
+        glGetActiveUniform(programID,
+                (GLuint)i,
+                maxLength,
+                &length,
+                &size,
+                &type,
+                &name[0]);
+        std::string uniformName(name, 0, (size_t)length);
+
+        // uniforms in a block have no location
+        GLint location = glGetUniformLocation(programID, uniformName.c_str());
+        if (location == -1) {
+            continue;
+        }
+        uniformLocations[uniformName] = location;
+
+        // arrays are reported as "name[0]", also cache "name" and every
+        // "name[i]"
+        size_t bracket = uniformName.rfind("[0]");
+        if (bracket == std::string::npos ||
+                bracket + 3 != uniformName.size()) {
+            continue;
+        }
+        std::string baseName = uniformName.substr(0, bracket);
+        uniformLocations[baseName] = location;
+        for (GLint element = 1; element < size; element++) {
+            std::string elementName =
+                    baseName + "[" + std::to_string(element) + "]";
+            uniformLocations[elementName] =
+                    glGetUniformLocation(programID, elementName.c_str());
+        }
+    }
 }
 
 void Shader::use() {
     glUseProgram(programID);
 }
 
+void Shader::use(GLStateCache& state) {
+    state.useProgram(programID);
+}
+
+UniformHandle Shader::getUniform(const std::string& name) const {
+    std::unordered_map<std::string, GLint>::const_iterator it =
+            uniformLocations.find(name);
+    if (it == uniformLocations.end()) {
+        return UniformHandle();
+    }
+    return UniformHandle(it->second);
+}
+
 void Shader::setBool(const std::string& name, bool value) const {
-    glUniform1i(glGetUniformLocation(programID, name.c_str()), (int)value);
+    setBool(getUniform(name), value);
 }
 
 void Shader::setInt(const std::string& name, int value) const {
-    glUniform1i(glGetUniformLocation(programID, name.c_str()), value);
+    setInt(getUniform(name), value);
 }
 
 void Shader::setFloat(const std::string& name, float value) const {
-    glUniform1f(glGetUniformLocation(programID, name.c_str()), value);
+    setFloat(getUniform(name), value);
+}
+
+void Shader::setVec2(const std::string& name, float x, float y) const {
+    setVec2(getUniform(name), x, y);
+}
+
+void Shader::setVec3(
+        const std::string& name, float x, float y, float z) const {
+    setVec3(getUniform(name), x, y, z);
+}
+
+void Shader::setMat4(const std::string& name, const GLfloat* value) const {
+    setMat4(getUniform(name), value);
+}
+
+void Shader::setBool(UniformHandle uniform, bool value) const {
+    glUniform1i(uniform.location, (int)value);
+}
+
+void Shader::setInt(UniformHandle uniform, int value) const {
+    glUniform1i(uniform.location, value);
+}
+
+void Shader::setFloat(UniformHandle uniform, float value) const {
+    glUniform1f(uniform.location, value);
+}
+
+void Shader::setVec2(UniformHandle uniform, float x, float y) const {
+    glUniform2f(uniform.location, x, y);
+}
+
+void Shader::setVec3(UniformHandle uniform, float x, float y, float z)
+        const {
+    glUniform3f(uniform.location, x, y, z);
+}
+
+void Shader::setMat4(UniformHandle uniform, const GLfloat* value) const {
+    glUniformMatrix4fv(uniform.location, 1, GL_FALSE, value);
 }
@@ -3,23 +3,97 @@
 
 #include <glad/glad.h>
 
+#include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+
+class GLStateCache;
+class ShaderWatcher;
+
+// Location of a uniform in one Shader's program, fetch it once with
+// Shader::getUniform() and reuse it in hot loops. -1 (inactive or unknown
+// uniform) is ignored by the setters just like by glUniform*().
+struct UniformHandle {
+    GLint location;
+
+    explicit UniformHandle(GLint location = -1) : location(location) {
+    }
+    bool isValid() const {
+        return location != -1;
+    }
+};
 
 class Shader {
   public:
     // the program id
     unsigned int programID;
 
-    // constructor reads and builds the shader
+    // constructor reads and builds the shader, or loads the linked program
+    // from the binary cache when the sources and driver are unchanged
     Shader(const GLchar* vertexPath, const GLchar* fragmentPath);
+    ~Shader();
+
+    // directory for cached program binaries, an empty path turns the cache
+    // off. Defaults to SHADER_CACHE_DIR when that is defined.
+    static void setBinaryCacheDirectory(const std::string& directory);
     // use/activate the shader
     void use();
+    // same, skipped when the cache already has it in use
+    void use(GLStateCache& state);
+    // cached uniform location, no driver call
+    UniformHandle getUniform(const std::string& name) const;
     // utility uniform functions
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int value) const;
     void setFloat(const std::string& name, float value) const;
+    void setVec2(const std::string& name, float x, float y) const;
+    void setVec3(const std::string& name, float x, float y, float z) const;
+    void setMat4(const std::string& name, const GLfloat* value) const;
+    // same, with a handle from getUniform()
+    void setBool(UniformHandle uniform, bool value) const;
+    void setInt(UniformHandle uniform, int value) const;
+    void setFloat(UniformHandle uniform, float value) const;
+    void setVec2(UniformHandle uniform, float x, float y) const;
+    void setVec3(UniformHandle uniform, float x, float y, float z) const;
+    void setMat4(UniformHandle uniform, const GLfloat* value) const;
+
+    // hot reload, opt-in: watch() starts watching both source files on a
+    // background thread, reloadIfChanged() is then called once per frame on
+    // the GL thread. programID is only replaced when the new sources compile
+    // and link, and since uniform values and locations belong to the program
+    // the caller should set its uniforms and refetch handles when it returns
+    // true.
+    void watch();
+    bool reloadIfChanged();
+    // rebuilds from the source files right away
+    bool reload();
+    // same, for a program used through state, which learns about the swap
+    bool reloadIfChanged(GLStateCache& state);
+    bool reload(GLStateCache& state);
+
+  private:
+    std::string vertexPath;
+    std::string fragmentPath;
+    // name -> location of every active uniform, filled once after linking
+    std::unordered_map<std::string, GLint> uniformLocations;
+    std::unique_ptr<ShaderWatcher> watcher;
+
+    static std::string binaryCacheDirectory;
+
+    bool readSources(std::string& vertexCode, std::string& fragmentCode);
+    bool buildProgram(const std::string& vertexCode,
+            const std::string& fragmentCode,
+            unsigned int& program);
+    void cacheUniforms();
+    bool rebuild(GLStateCache* state);
+    std::string binaryCachePath(
+            const std::string& vertexCode, const std::string& fragmentCode);
+    bool loadProgramBinary(const std::string& path, unsigned int& program);
+    void saveProgramBinary(unsigned int program, const std::string& path);
 };
 #endif
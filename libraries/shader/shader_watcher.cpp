@@ -0,0 +1,118 @@
+#include "shader_watcher.h"
+
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <chrono>
+
+namespace {
+// split "dir/name" into "dir" and "name"
+void splitPath(const std::string& path, std::string& dir, std::string& name) {
+    size_t slash = path.find_last_of("/\\");
+    if (slash == std::string::npos) {
+        dir = ".";
+        name = path;
+    } else {
+        dir = path.substr(0, slash);
+        name = path.substr(slash + 1);
+    }
+}
+
+long long modificationTime(const std::string& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return 0;
+    }
+    return (long long)info.st_mtime;
+}
+} // namespace
+
+ShaderWatcher::ShaderWatcher(const std::vector<std::string>& paths)
+        : paths(paths), changed(false), stopping(false), inotifyFd(-1) {
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd != -1) {
+        for (size_t i = 0; i < paths.size(); i++) {
+            std::string dir, name;
+            splitPath(paths[i], dir, name);
+            // watching the same directory twice just returns the same watch
+            // a save either closes the written file or renames a finished
+            // one over it, IN_CREATE would fire before there is anything
+            // to read
+            inotify_add_watch(
+                    inotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        }
+    }
+#endif
+    thread = std::thread(&ShaderWatcher::run, this);
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    stopping = true;
+    thread.join();
+#ifdef __linux__
+    if (inotifyFd != -1) {
+        close(inotifyFd);
+    }
+#endif
+}
+
+bool ShaderWatcher::poll() {
+    return changed.exchange(false);
+}
+
+void ShaderWatcher::run() {
+#ifdef __linux__
+    if (inotifyFd != -1) {
+        std::vector<std::string> names(paths.size());
+        for (size_t i = 0; i < paths.size(); i++) {
+            std::string dir;
+            splitPath(paths[i], dir, names[i]);
+        }
+
+        // wake up every 100 ms to notice the destructor
+        pollfd fds = {inotifyFd, POLLIN, 0};
+        alignas(inotify_event) char buffer[4096];
+        while (!stopping) {
+            if (::poll(&fds, 1, 100) <= 0) {
+                continue;
+            }
+            ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+            for (ssize_t offset = 0; offset < length;) {
+                const inotify_event* event =
+                        (const inotify_event*)(buffer + offset);
+                offset += (ssize_t)(sizeof(inotify_event) + event->len);
+                if (event->len == 0) {
+                    continue;
+                }
+                for (size_t i = 0; i < names.size(); i++) {
+                    if (names[i] == event->name) {
+                        changed = true;
+                    }
+                }
+            }
+        }
+        return;
+    }
+#endif
+
+    std::vector<long long> times(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        times[i] = modificationTime(paths[i]);
+    }
+    while (!stopping) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        for (size_t i = 0; i < paths.size(); i++) {
+            long long time = modificationTime(paths[i]);
+            if (time != times[i]) {
+                times[i] = time;
+                changed = true;
+            }
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Watches a few files on a background thread and raises a flag when any of
+// them is written. Uses inotify on Linux (watching the parent directories, so
+// editors that save by renaming a temporary file are caught too) and polls
+// modification times everywhere else.
+class ShaderWatcher {
+  public:
+    explicit ShaderWatcher(const std::vector<std::string>& paths);
+    ~ShaderWatcher();
+
+    // true once for every batch of changes since the last call
+    bool poll();
+
+  private:
+    void run();
+
+    std::vector<std::string> paths;
+    std::atomic<bool> changed;
+    std::atomic<bool> stopping;
+    int inotifyFd;
+    std::thread thread;
+};
+#endif
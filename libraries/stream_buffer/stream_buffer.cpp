@@ -0,0 +1,118 @@
+#include "stream_buffer.h"
+
+StreamBuffer::StreamBuffer(GLenum target, GLsizeiptr frameSize, int frameCount)
+        : target(target),
+          buffer(0),
+          frameSize(frameSize),
+          frameCount(frameCount > 0 ? frameCount : 1),
+          frame(0),
+          frameUsed(0),
+          persistentData(NULL),
+          mapped(false),
+          fences((size_t)(frameCount > 0 ? frameCount : 1), (GLsync)0) {
+    GLsizeiptr totalSize = frameSize * this->frameCount;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+
+    if (GLAD_GL_ARB_buffer_storage) {
+        GLbitfield flags =
+                GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, totalSize, NULL, flags);
+        persistentData = (unsigned char*)glMapBufferRange(
+                target, 0, totalSize, flags);
+    }
+    if (persistentData == NULL) {
+        if (GLAD_GL_ARB_buffer_storage) {
+            // Immutable storage can't be respecified, start over with a
+            // fresh buffer
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+            glBindBuffer(target, buffer);
+        }
+        // Mutable storage, mapped span by span
+        glBufferData(target, totalSize, NULL, GL_STREAM_DRAW);
+    }
+}
+
+void StreamBuffer::beginFrame() {
+    GLsync fence = fences[(size_t)frame];
+    if (fence != 0) {
+        // Normally already signalled, frameCount - 1 frames have passed
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        while (result == GL_TIMEOUT_EXPIRED) {
+            result = glClientWaitSync(
+                    fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        glDeleteSync(fence);
+        fences[(size_t)frame] = 0;
+    }
+    frameUsed = 0;
+}
+
+StreamAllocation StreamBuffer::map(GLsizeiptr size, GLsizeiptr alignment) {
+    StreamAllocation allocation;
+    allocation.data = NULL;
+    allocation.offset = 0;
+    allocation.size = size;
+
+    GLsizeiptr start = frameUsed;
+    if (alignment > 1 && start % alignment != 0) {
+        start += alignment - start % alignment;
+    }
+    if (mapped || size <= 0 || start + size > frameSize) {
+        return allocation;
+    }
+    frameUsed = start + size;
+    allocation.offset = (GLintptr)(frame * frameSize + start);
+
+    glBindBuffer(target, buffer);
+    if (persistentData != NULL) {
+        allocation.data = persistentData + allocation.offset;
+    } else {
+        allocation.data = glMapBufferRange(target,
+                allocation.offset,
+                size,
+                GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                        GL_MAP_INVALIDATE_RANGE_BIT);
+        mapped = allocation.data != NULL;
+    }
+    return allocation;
+}
+
+void StreamBuffer::unmap() {
+    if (mapped) {
+        glBindBuffer(target, buffer);
+        glUnmapBuffer(target);
+        mapped = false;
+    }
+}
+
+void StreamBuffer::endFrame() {
+    unmap();
+    fences[(size_t)frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame = (frame + 1) % frameCount;
+}
+
+GLuint StreamBuffer::getBuffer() const {
+    return buffer;
+}
+
+bool StreamBuffer::isPersistent() const {
+    return persistentData != NULL;
+}
+
+void StreamBuffer::release() {
+    for (size_t i = 0; i < fences.size(); i++) {
+        if (fences[i] != 0) {
+            glDeleteSync(fences[i]);
+            fences[i] = 0;
+        }
+    }
+    if (buffer != 0) {
+        // Deleting the buffer unmaps it as well
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+        persistentData = NULL;
+        mapped = false;
+    }
+}
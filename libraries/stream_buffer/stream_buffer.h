@@ -0,0 +1,66 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+// Span of a StreamBuffer to write this frame's data into
+struct StreamAllocation {
+    // write only, NULL when the frame's region is full
+    void* data;
+    // where the span starts in the buffer, for glVertexAttribPointer,
+    // glBindBufferRange or as a pixel unpack offset
+    GLintptr offset;
+    GLsizeiptr size;
+};
+
+// Ring buffer for data that changes every frame (instances, uniforms,
+// texture staging). The buffer is split into one region per frame in
+// flight, each region is fenced when its frame ends and only reused once
+// the GPU is done with it, so writes never stall on the driver.
+// With GL_ARB_buffer_storage the whole buffer stays mapped persistently
+// and coherently. Otherwise each map() maps just its span with
+// GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT, which is safe
+// because the fence already did the synchronizing.
+class StreamBuffer {
+  public:
+    // frameSize bytes per frame, frameCount frames in flight
+    StreamBuffer(GLenum target, GLsizeiptr frameSize, int frameCount = 3);
+
+    // waits until the GPU has finished with the region this frame reuses
+    void beginFrame();
+    // takes size bytes from the current frame, offset aligned to alignment
+    // (use GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT for uniform blocks)
+    StreamAllocation map(GLsizeiptr size, GLsizeiptr alignment = 16);
+    // must be called after writing and before drawing from the span, only
+    // one span can be mapped at a time. A successful map() leaves the buffer
+    // bound to target, persistent or not.
+    void unmap();
+    // fences the commands that read this frame's region
+    void endFrame();
+
+    GLuint getBuffer() const;
+    bool isPersistent() const;
+    // deletes the buffer, call it while the context is still current
+    void release();
+
+  private:
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    GLenum target;
+    GLuint buffer;
+    GLsizeiptr frameSize;
+    int frameCount;
+    int frame;
+    // bytes of the current frame's region handed out so far
+    GLsizeiptr frameUsed;
+
+    // whole buffer when persistent, NULL otherwise
+    unsigned char* persistentData;
+    bool mapped;
+    std::vector<GLsync> fences;
+};
+#endif
@@ -0,0 +1,236 @@
+#include "terrain.h"
+
+#include <algorithm>
+#include <cmath>
+
+TerrainStreamer::TerrainStreamer(JobSystem& jobSystem,
+        const FastNoise& noise,
+        int chunkSize,
+        size_t memoryBudget)
+        : jobSystem(jobSystem),
+          noise(noise),
+          chunkSize(chunkSize),
+          memoryBudget(memoryBudget),
+          updateCount(0),
+          queuedJobs(0),
+          runningJobs(0) {
+}
+
+TerrainStreamer::~TerrainStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.clear();
+    }
+    jobSystem.wait();
+}
+
+int TerrainStreamer::getChunkSize() const {
+    return chunkSize;
+}
+
+size_t TerrainStreamer::getChunkBytes() const {
+    return (size_t)(chunkSize + 1) * (size_t)(chunkSize + 1) * sizeof(float);
+}
+
+size_t TerrainStreamer::getMemoryBudget() const {
+    return memoryBudget;
+}
+
+size_t TerrainStreamer::getMemoryUsed() const {
+    return resident.size() * getChunkBytes();
+}
+
+size_t TerrainStreamer::getResidentCount() const {
+    return resident.size();
+}
+
+size_t TerrainStreamer::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size() + inFlight.size();
+}
+
+ChunkCoord TerrainStreamer::chunkAt(float x, float z) const {
+    ChunkCoord coord;
+    coord.x = (int)std::floor(x / (float)chunkSize);
+    coord.z = (int)std::floor(z / (float)chunkSize);
+    return coord;
+}
+
+float TerrainStreamer::distanceSquared(ChunkCoord coord, float x, float z)
+        const {
+    float dx = ((float)coord.x + 0.5f) * (float)chunkSize - x;
+    float dz = ((float)coord.z + 0.5f) * (float)chunkSize - z;
+    return dx * dx + dz * dz;
+}
+
+void TerrainStreamer::update(float x, float z, int radius) {
+    updateCount++;
+    loaded.clear();
+    evicted.clear();
+
+    std::vector<std::unique_ptr<TerrainChunk> > done;
+    std::unique_lock<std::mutex> lock(mutex);
+    done.swap(finished);
+    for (size_t i = 0; i < done.size(); i++) {
+        ChunkCoord coord = done[i]->coord;
+        inFlight.erase(coord);
+        loaded.push_back(coord);
+        resident[coord] = std::move(done[i]);
+    }
+
+    // Chunks whose centre is in range, nearest first. The coordinates break
+    // ties so the order doesn't depend on the hash map.
+    ChunkCoord centre = chunkAt(x, z);
+    float reach = (float)(radius * chunkSize);
+    std::vector<std::pair<float, ChunkCoord> > wanted;
+    for (int cz = centre.z - radius - 1; cz <= centre.z + radius + 1; cz++) {
+        for (int cx = centre.x - radius - 1; cx <= centre.x + radius + 1;
+                cx++) {
+            ChunkCoord coord = {cx, cz};
+            float distance = distanceSquared(coord, x, z);
+            if (distance <= reach * reach) {
+                wanted.push_back(std::make_pair(distance, coord));
+            }
+        }
+    }
+    std::sort(wanted.begin(),
+            wanted.end(),
+            [](const std::pair<float, ChunkCoord>& a,
+                    const std::pair<float, ChunkCoord>& b) {
+                if (a.first != b.first) {
+                    return a.first < b.first;
+                }
+                return a.second.z != b.second.z ? a.second.z < b.second.z
+                                                : a.second.x < b.second.x;
+            });
+
+    // The nearest ones that fit, the rest wait until the camera comes closer
+    size_t maxChunks = memoryBudget / getChunkBytes();
+    maxChunks = maxChunks > 0 ? maxChunks : 1;
+    if (wanted.size() > maxChunks) {
+        wanted.resize(maxChunks);
+    }
+
+    std::vector<ChunkCoord> missing;
+    for (size_t i = 0; i < wanted.size(); i++) {
+        ChunkMap::iterator found = resident.find(wanted[i].second);
+        if (found != resident.end()) {
+            found->second->lastUsed = updateCount;
+        } else if (inFlight.count(wanted[i].second) == 0) {
+            missing.push_back(wanted[i].second);
+        }
+    }
+
+    // Evict the least recently wanted chunks until the missing ones fit.
+    // Chunks still being generated count against the budget already.
+    size_t needed = resident.size() + inFlight.size() + missing.size();
+    if (needed > maxChunks) {
+        std::vector<std::pair<float, TerrainChunk*> > stale;
+        for (ChunkMap::iterator it = resident.begin(); it != resident.end();
+                ++it) {
+            if (it->second->lastUsed != updateCount) {
+                stale.push_back(std::make_pair(
+                        distanceSquared(it->first, x, z), it->second.get()));
+            }
+        }
+        std::sort(stale.begin(),
+                stale.end(),
+                [](const std::pair<float, TerrainChunk*>& a,
+                        const std::pair<float, TerrainChunk*>& b) {
+                    if (a.second->lastUsed != b.second->lastUsed) {
+                        return a.second->lastUsed < b.second->lastUsed;
+                    }
+                    if (a.first != b.first) {
+                        return a.first > b.first;
+                    }
+                    ChunkCoord ca = a.second->coord;
+                    ChunkCoord cb = b.second->coord;
+                    return ca.z != cb.z ? ca.z < cb.z : ca.x < cb.x;
+                });
+        for (size_t i = 0; i < stale.size() && needed > maxChunks; i++) {
+            ChunkCoord coord = stale[i].second->coord;
+            evicted.push_back(coord);
+            resident.erase(coord);
+            needed--;
+        }
+    }
+
+    size_t used = resident.size() + inFlight.size();
+    size_t room = maxChunks > used ? maxChunks - used : 0;
+    if (missing.size() > room) {
+        missing.resize(room);
+    }
+    // Replaces last frame's queue, chunks that left the range are dropped
+    queue.assign(missing.rbegin(), missing.rend());
+
+    int maxJobs = (int)jobSystem.getThreadCount();
+    int jobs = 0;
+    while (queuedJobs + runningJobs < maxJobs &&
+            queuedJobs < (int)queue.size()) {
+        queuedJobs++;
+        jobs++;
+    }
+    lock.unlock();
+
+    for (int i = 0; i < jobs; i++) {
+        jobSystem.submit([this] { generateNext(); });
+    }
+}
+
+void TerrainStreamer::generateNext() {
+    std::unique_ptr<TerrainChunk> chunk(new TerrainChunk());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queuedJobs--;
+        if (queue.empty()) {
+            return;
+        }
+        // Nearest to the camera as of the last update()
+        chunk->coord = queue.back();
+        queue.pop_back();
+        inFlight.insert(chunk->coord);
+        runningJobs++;
+    }
+    chunk->lastUsed = 0;
+    generate(*chunk);
+
+    // One chunk per job so a queue that moved on is picked up right away,
+    // the job queues the next one itself
+    bool more = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.push_back(std::move(chunk));
+        runningJobs--;
+        if (queuedJobs + runningJobs < (int)jobSystem.getThreadCount() &&
+                queuedJobs < (int)queue.size()) {
+            queuedJobs++;
+            more = true;
+        }
+    }
+    if (more) {
+        jobSystem.submit([this] { generateNext(); });
+    }
+}
+
+void TerrainStreamer::generate(TerrainChunk& chunk) const {
+    int samples = chunkSize + 1;
+    chunk.heights.resize((size_t)samples * (size_t)samples);
+    noise.FillGrid2D(&chunk.heights[0],
+            chunk.coord.x * chunkSize,
+            chunk.coord.z * chunkSize,
+            samples,
+            samples);
+}
+
+const TerrainChunk* TerrainStreamer::getChunk(ChunkCoord coord) const {
+    ChunkMap::const_iterator found = resident.find(coord);
+    return found != resident.end() ? found->second.get() : nullptr;
+}
+
+const std::vector<ChunkCoord>& TerrainStreamer::getLoaded() const {
+    return loaded;
+}
+
+const std::vector<ChunkCoord>& TerrainStreamer::getEvicted() const {
+    return evicted;
+}
@@ -0,0 +1,118 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include <FastNoise.h>
+#include <job_system.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Integer position of a chunk, chunk (x, z) covers world samples
+// x * size .. (x + 1) * size and the same in z
+struct ChunkCoord {
+    int x;
+    int z;
+};
+
+inline bool operator==(ChunkCoord a, ChunkCoord b) {
+    return a.x == b.x && a.z == b.z;
+}
+
+struct ChunkCoordHash {
+    size_t operator()(ChunkCoord coord) const {
+        return (size_t)((unsigned int)coord.x * 73856093u ^
+                        (unsigned int)coord.z * 19349663u);
+    }
+};
+
+// (size + 1) * (size + 1) heights, row major with x varying fastest. The
+// last row and column are the first ones of the next chunks over, so
+// neighbouring meshes meet without cracks.
+struct TerrainChunk {
+    ChunkCoord coord;
+    std::vector<float> heights;
+    unsigned long lastUsed; // update() that last wanted it
+};
+
+// Infinite terrain cut into square chunks. Chunks around the camera are
+// generated on a JobSystem nearest first, kept in a least recently used
+// cache bounded by memoryBudget bytes of heights and regenerated when they
+// come back into range. A chunk's heights only depend on its coordinates
+// and the noise, so an evicted chunk comes back identical.
+class TerrainStreamer {
+  public:
+    // The noise is copied and shared read-only by the workers. At least
+    // one chunk is always allowed whatever the budget. Chunks are generated
+    // one per job, so a wait() on jobSystem also waits for the queue.
+    TerrainStreamer(JobSystem& jobSystem,
+            const FastNoise& noise,
+            int chunkSize = 64,
+            size_t memoryBudget = 64 * 1024 * 1024);
+    // Drops the chunks not started yet and waits for the running ones
+    ~TerrainStreamer();
+
+    TerrainStreamer(const TerrainStreamer&) = delete;
+    TerrainStreamer& operator=(const TerrainStreamer&) = delete;
+
+    int getChunkSize() const;
+    // Bytes of one chunk's heights
+    size_t getChunkBytes() const;
+    size_t getMemoryBudget() const;
+    size_t getMemoryUsed() const;
+    size_t getResidentCount() const;
+    // Chunks queued or being generated
+    size_t getPendingCount() const;
+
+    ChunkCoord chunkAt(float x, float z) const;
+
+    // Called once per frame from the thread that reads the chunks. Wants
+    // every chunk whose centre is within radius chunks of (x, z), nearest
+    // first and as many as the budget holds. Picks up the chunks finished
+    // since the last call, evicts the least recently wanted ones to make
+    // room and queues the missing ones. Chunks that were wanted in the same
+    // update are never evicted. Ties go to the farthest chunk and then the
+    // coordinates, never to hash map order.
+    void update(float x, float z, int radius);
+
+    // Resident chunk, nullptr when it is not generated or was evicted
+    const TerrainChunk* getChunk(ChunkCoord coord) const;
+    // Chunks that became resident or were evicted by the last update(), so
+    // a renderer can build and free their meshes
+    const std::vector<ChunkCoord>& getLoaded() const;
+    const std::vector<ChunkCoord>& getEvicted() const;
+
+  private:
+    typedef std::unordered_map<ChunkCoord,
+            std::unique_ptr<TerrainChunk>,
+            ChunkCoordHash>
+            ChunkMap;
+
+    // Job body: takes the nearest queued chunk, if any is left
+    void generateNext();
+    void generate(TerrainChunk& chunk) const;
+    float distanceSquared(ChunkCoord coord, float x, float z) const;
+
+    JobSystem& jobSystem;
+    FastNoise noise;
+    int chunkSize;
+    size_t memoryBudget;
+    unsigned long updateCount;
+
+    // Only touched by update() and the getters
+    ChunkMap resident;
+    std::vector<ChunkCoord> loaded;
+    std::vector<ChunkCoord> evicted;
+
+    // Shared with the jobs
+    mutable std::mutex mutex;
+    std::vector<ChunkCoord> queue; // Farthest first, jobs pop the back
+    std::unordered_set<ChunkCoord, ChunkCoordHash> inFlight;
+    std::vector<std::unique_ptr<TerrainChunk> > finished;
+    int queuedJobs;
+    int runningJobs;
+};
+#endif
@@ -1,6 +1,7 @@
 #include <GLFW/glfw3.h>
 #include <find_resource.h>
 #include <glad/glad.h>
+#include <gl_state.h>
 #include <shader.h>
 #include <stb_image.h>
 
@@ -167,6 +168,7 @@ int main() {
     glUniform1i(glGetUniformLocation(ourShader.programID, "ourTexture1"), 0);
     ourShader.setInt("ourTexture2", 1);
 
+    GLStateCache state;
     while (!glfwWindowShouldClose(window)) {
         // Input
         processInput(window);
@@ -175,15 +177,14 @@ int main() {
         glClearColor(0.102f, 0.110f, 0.118f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        ourShader.use();
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, textures[0]);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, textures[1]);
+        // Nothing changes between frames, so after the first one all of
+        // these are skipped
+        ourShader.use(state);
+        state.bindTexture(0, GL_TEXTURE_2D, textures[0]);
+        state.bindTexture(1, GL_TEXTURE_2D, textures[1]);
 
-        glBindVertexArray(VAO);
+        state.bindVertexArray(VAO);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
 
         // Check and call events and swap the buffer
         glfwSwapBuffers(window);
@@ -196,6 +197,9 @@ int main() {
     glDeleteBuffers(1, &EBO);
     glDeleteTextures(1, textures);
 
+    std::cout << "GL binds: " << state.getIssued() << " issued, "
+              << state.getSkipped() << " skipped" << std::endl;
+
     glfwTerminate();
     return 0;
 }
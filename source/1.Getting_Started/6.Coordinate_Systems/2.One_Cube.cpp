@@ -1,6 +1,7 @@
 #include <GLFW/glfw3.h>
 #include <find_resource.h>
 #include <glad/glad.h>
+#include <mesh.h>
 #include <shader.h>
 #include <stb_image.h>
 
@@ -103,28 +104,12 @@ int main() {
 
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
-    unsigned int VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    // Bind VAO
-    glBindVertexArray(VAO);
-    // Copy our vertices array to a buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    // Set the vertex VAO
-    glVertexAttribPointer(
-            0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Set the textures VAO
-    glVertexAttribPointer(1,
-            2,
-            GL_FLOAT,
-            GL_FALSE,
-            5 * sizeof(float),
-            (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
+    // The 36 vertices share corners, index them and store half floats
+    Mesh cube(vertices,
+            sizeof(vertices) / (5 * sizeof(float)),
+            {3, 2},
+            Mesh::HalfFloat);
+    cube.upload();
 
     unsigned int textures[2];
     glActiveTexture(GL_TEXTURE0);
@@ -237,8 +222,7 @@ int main() {
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, textures[1]);
 
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        cube.draw();
         glBindVertexArray(0);
 
         // Check and call events and swap the buffer
@@ -247,8 +231,7 @@ int main() {
     }
 
     // optional: de-allocate all resources once they've outlived their purpose:
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
+    cube.release();
     glDeleteTextures(1, textures);
 
     glfwTerminate();
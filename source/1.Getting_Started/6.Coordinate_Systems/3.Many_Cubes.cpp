@@ -1,6 +1,9 @@
 #include <GLFW/glfw3.h>
 #include <find_resource.h>
 #include <glad/glad.h>
+#include <gl_state.h>
+#include <mesh.h>
+#include <render_queue.h>
 #include <shader.h>
 #include <stb_image.h>
 
@@ -116,28 +119,12 @@ int main() {
 
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
-    unsigned int VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    // Bind VAO
-    glBindVertexArray(VAO);
-    // Copy our vertices array to a buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    // Set the vertex VAO
-    glVertexAttribPointer(
-            0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Set the textures VAO
-    glVertexAttribPointer(1,
-            2,
-            GL_FLOAT,
-            GL_FALSE,
-            5 * sizeof(float),
-            (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
+    // Indexed half float copy of vertices[], shared by all ten cubes
+    Mesh cube(vertices,
+            sizeof(vertices) / (5 * sizeof(float)),
+            {3, 2},
+            Mesh::HalfFloat);
+    cube.upload();
 
     unsigned int textures[2];
     glActiveTexture(GL_TEXTURE0);
@@ -212,6 +199,19 @@ int main() {
     ourShader.setInt("ourTexture2", 1);
     glEnable(GL_DEPTH_TEST);
 
+    // Looked up once, not every frame
+    UniformHandle modelLoc = ourShader.getUniform("model");
+    UniformHandle viewLoc = ourShader.getUniform("view");
+    UniformHandle projectionLoc = ourShader.getUniform("projection");
+
+    GLStateCache state;
+    RenderQueue queue(state);
+
+    RenderMaterial material;
+    material.textures[0] = textures[0];
+    material.textures[1] = textures[1];
+    material.textureCount = 2;
+
     while (!glfwWindowShouldClose(window)) {
         // Input
         processInput(window);
@@ -220,7 +220,7 @@ int main() {
         glClearColor(0.102f, 0.110f, 0.118f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        ourShader.use();
+        ourShader.use(state);
 
         glm::mat4 view = glm::mat4(1.0f);
         glm::mat4 projection = glm::mat4(1.0f);
@@ -230,22 +230,9 @@ int main() {
                 0.1f,
                 100.0f);
 
-        unsigned int modelLoc =
-                glGetUniformLocation(ourShader.programID, "model");
-        unsigned int viewLoc =
-                glGetUniformLocation(ourShader.programID, "view");
-        unsigned int projectionLoc =
-                glGetUniformLocation(ourShader.programID, "projection");
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(
-                projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, textures[0]);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, textures[1]);
-
-        glBindVertexArray(VAO);
+        ourShader.setMat4(viewLoc, glm::value_ptr(view));
+        ourShader.setMat4(projectionLoc, glm::value_ptr(projection));
+
         for (unsigned int i = 0; i < 10; i++) {
             glm::mat4 model = glm::mat4(1.0f);
             model = glm::translate(model, cubePositions[i]);
@@ -255,10 +242,14 @@ int main() {
                     (float)glfwGetTime() * glm::radians(angle),
                     glm::vec3(1.0f, 0.3f, 0.5f));
 
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            queue.submit(ourShader,
+                    material,
+                    cube,
+                    modelLoc,
+                    glm::value_ptr(model));
         }
-        glBindVertexArray(0);
+        // Sorted, the ten cubes share one program, material and VAO bind
+        queue.flush();
 
         // Check and call events and swap the buffer
         glfwSwapBuffers(window);
@@ -266,10 +257,12 @@ int main() {
     }
 
     // optional: de-allocate all resources once they've outlived their purpose:
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
+    cube.release();
     glDeleteTextures(1, textures);
 
+    std::cout << "GL binds: " << state.getIssued() << " issued, "
+              << state.getSkipped() << " skipped" << std::endl;
+
     glfwTerminate();
     return 0;
 }
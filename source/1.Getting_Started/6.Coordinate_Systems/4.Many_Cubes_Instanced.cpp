@@ -0,0 +1,364 @@
+#include <GLFW/glfw3.h>
+#include <culling.h>
+#include <find_resource.h>
+#include <glad/glad.h>
+#include <job_system.h>
+#include <mesh.h>
+#include <shader.h>
+#include <stream_buffer.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+int screenWidth = 800;
+int screenHeight = 600;
+
+#if defined(__GNUC__) || defined(__GNUG__)
+void framebuffer_size_callback(
+        __attribute__((unused)) GLFWwindow* window, int width, int height) {
+    glViewport(0, 0, width, height);
+}
+#elif defined(_MSC_VER)
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    (void)window;
+    screenWidth = height;
+    screenHeight = height;
+    glViewport(0, 0, width, height);
+}
+#endif
+
+void processInput(GLFWwindow* window) {
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+        glfwSetWindowShouldClose(window, true);
+    }
+}
+
+// clang-format off
+float vertices[] = {
+    // positions          // texture coords
+    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+     0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+};
+// clang-format on
+
+int main(int argc, char** argv) {
+    // The cube count can be overridden from the command line
+    unsigned int cubeCount = 100000;
+    if (argc > 1) {
+        cubeCount = (unsigned int)std::strtoul(argv[1], NULL, 10);
+    }
+    if (cubeCount == 0) {
+        cubeCount = 1;
+    }
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWwindow* window =
+            glfwCreateWindow(800, 600, "Many Cubes Instanced", NULL, NULL);
+    if (window == NULL) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    glViewport(0, 0, 800, 600);
+
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // Indexed half floats, 12 byte vertices instead of 20
+    Mesh cube(vertices,
+            sizeof(vertices) / (5 * sizeof(float)),
+            {3, 2},
+            Mesh::HalfFloat);
+    cube.upload();
+
+    // Per-instance model matrices go on the cube's VAO. A mat4 attribute
+    // takes four consecutive locations, one vec4 column each, advanced once
+    // per instance. The pointers are set every frame, the matrices move
+    // around a ring of three frames' worth of storage.
+    StreamBuffer instances(
+            GL_ARRAY_BUFFER, (GLsizeiptr)(cubeCount * sizeof(glm::mat4)));
+    glBindVertexArray(cube.getVAO());
+    for (unsigned int column = 0; column < 4; column++) {
+        glEnableVertexAttribArray(2 + column);
+        glVertexAttribDivisor(2 + column, 1);
+    }
+    glBindVertexArray(0);
+
+    unsigned int textures[2];
+    glActiveTexture(GL_TEXTURE0);
+    glGenTextures(2, textures);
+    glBindTexture(GL_TEXTURE_2D, textures[0]);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    // Load and generate the texture
+    int width, height, nrChannels;
+    stbi_set_flip_vertically_on_load(true);
+    Resources resources;
+    unsigned char* data = stbi_load(
+            resources.getResourcePath("/textures/container.jpg").c_str(),
+            &width,
+            &height,
+            &nrChannels,
+            0);
+    if (data) {
+        glTexImage2D(GL_TEXTURE_2D,
+                0,
+                GL_RGB,
+                width,
+                height,
+                0,
+                GL_RGB,
+                GL_UNSIGNED_BYTE,
+                data);
+    } else {
+        std::cout << "Failed to load texture" << std::endl;
+    }
+    stbi_image_free(data);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, textures[1]);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    // Load and generate the texture
+    data = stbi_load(
+            resources.getResourcePath("/textures/awesomeface.png").c_str(),
+            &width,
+            &height,
+            &nrChannels,
+            0);
+    if (data) {
+        glTexImage2D(GL_TEXTURE_2D,
+                0,
+                GL_RGBA,
+                width,
+                height,
+                0,
+                GL_RGBA,
+                GL_UNSIGNED_BYTE,
+                data);
+    } else {
+        std::cout << "Failed to load texture 2" << std::endl;
+    }
+    stbi_image_free(data);
+
+    std::string vertex = resources.getShaderPath(
+            "/1.Getting_Started/6.Coordinate_Systems/3.vertex.glsl");
+    std::string fragment = resources.getShaderPath(
+            "/1.Getting_Started/6.Coordinate_Systems/1.fragment.glsl");
+
+    Shader ourShader(vertex.c_str(), fragment.c_str());
+    ourShader.use();
+
+    ourShader.setInt("ourTexture1", 0);
+    ourShader.setInt("ourTexture2", 1);
+    glEnable(GL_DEPTH_TEST);
+
+    UniformHandle viewLoc = ourShader.getUniform("view");
+    UniformHandle projectionLoc = ourShader.getUniform("projection");
+
+    // Lay the cubes out on a cube shaped grid centred on the origin
+    const float spacing = 2.0f;
+    unsigned int side = (unsigned int)std::ceil(std::cbrt((double)cubeCount));
+    float offset = (float)(side - 1) * spacing * 0.5f;
+    std::vector<glm::vec3> cubePositions(cubeCount);
+    std::vector<float> cubeAngles(cubeCount);
+    // Bounding spheres for culling, a unit cube fits in a sqrt(3) / 2 one
+    // whichever way it is turned
+    std::vector<float> cubeX(cubeCount);
+    std::vector<float> cubeY(cubeCount);
+    std::vector<float> cubeZ(cubeCount);
+    std::vector<float> cubeRadius(cubeCount, 0.8660254f);
+    for (unsigned int i = 0; i < cubeCount; i++) {
+        unsigned int x = i % side;
+        unsigned int y = (i / side) % side;
+        unsigned int z = i / (side * side);
+        cubePositions[i] = glm::vec3((float)x * spacing - offset,
+                (float)y * spacing - offset,
+                (float)z * spacing - offset);
+        // Same spread of speeds as the non-instanced scene
+        unsigned int speed = i % 10;
+        cubeAngles[i] = 20.0f * (float)(speed == 0 ? 3 : speed);
+        cubeX[i] = cubePositions[i].x;
+        cubeY[i] = cubePositions[i].y;
+        cubeZ[i] = cubePositions[i].z;
+    }
+    SphereArrays cubeSpheres = {
+            &cubeX[0], &cubeY[0], &cubeZ[0], &cubeRadius[0]};
+    std::vector<unsigned int> visible(cubeCount);
+    Frustum frustum;
+    // Half way between grid points near the middle. With an odd side the
+    // origin is itself a cube, whose inside would fill the screen.
+    float middle = (float)(side / 2) * spacing - offset - spacing * 0.5f;
+    glm::vec3 eye(middle);
+    // Matrices are built on every core, 1024 (64 KiB) per job
+    JobSystem jobSystem;
+    const size_t transformChunk = 1024;
+
+    double lastTitleTime = glfwGetTime();
+    unsigned int framesSinceTitle = 0;
+
+    while (!glfwWindowShouldClose(window)) {
+        // Input
+        processInput(window);
+
+        float time = (float)glfwGetTime();
+
+        // Stand in the middle of the grid and turn slowly, so most of the
+        // cubes are behind or beside the camera at any time
+        glm::vec3 direction(
+                std::sin(time * 0.2f), 0.0f, -std::cos(time * 0.2f));
+        glm::mat4 view = glm::lookAt(
+                eye, eye + direction, glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f),
+                (float)screenWidth / (float)screenHeight,
+                0.1f,
+                offset * 2.0f + 1.0f);
+
+        // Only the cubes that pass the frustum test get a model matrix and
+        // an instance
+        frustum.setViewProjection(glm::value_ptr(projection * view));
+        size_t visibleCount =
+                frustum.cullSpheres(cubeSpheres, cubeCount, &visible[0]);
+        // Written straight into the mapped ring, no copy on our side or
+        // the driver's
+        instances.beginFrame();
+        StreamAllocation allocation = instances.map(
+                (GLsizeiptr)(visibleCount * sizeof(glm::mat4)),
+                sizeof(glm::mat4));
+        glm::mat4* models = (glm::mat4*)allocation.data;
+        if (models == NULL) {
+            visibleCount = 0;
+        }
+        jobSystem.parallelFor(
+                visibleCount, transformChunk, [&](size_t begin, size_t end) {
+                    for (size_t v = begin; v < end; v++) {
+                        unsigned int i = visible[v];
+                        glm::mat4 model = glm::translate(
+                                glm::mat4(1.0f), cubePositions[i]);
+                        models[v] = glm::rotate(model,
+                                time * glm::radians(cubeAngles[i]),
+                                glm::vec3(1.0f, 0.3f, 0.5f));
+                    }
+                });
+        instances.unmap();
+
+        glBindVertexArray(cube.getVAO());
+        glBindBuffer(GL_ARRAY_BUFFER, instances.getBuffer());
+        for (unsigned int column = 0; column < 4; column++) {
+            glVertexAttribPointer(2 + column,
+                    4,
+                    GL_FLOAT,
+                    GL_FALSE,
+                    sizeof(glm::mat4),
+                    (void*)(allocation.offset +
+                            column * sizeof(glm::vec4)));
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+
+        // Draw
+        glClearColor(0.102f, 0.110f, 0.118f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        ourShader.use();
+        ourShader.setMat4(viewLoc, glm::value_ptr(view));
+        ourShader.setMat4(projectionLoc, glm::value_ptr(projection));
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, textures[0]);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, textures[1]);
+
+        if (visibleCount > 0) {
+            cube.drawInstanced((GLsizei)visibleCount);
+        }
+        glBindVertexArray(0);
+        instances.endFrame();
+
+        // Report the frame time in the title once a second
+        framesSinceTitle++;
+        double now = glfwGetTime();
+        if (now - lastTitleTime >= 1.0) {
+            std::ostringstream title;
+            title << "Many Cubes Instanced - " << visibleCount << " of "
+                  << cubeCount << " cubes visible, "
+                  << (now - lastTitleTime) * 1000.0 / framesSinceTitle
+                  << " ms/frame";
+            glfwSetWindowTitle(window, title.str().c_str());
+            lastTitleTime = now;
+            framesSinceTitle = 0;
+        }
+
+        // Check and call events and swap the buffer
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    cube.release();
+    instances.release();
+    glDeleteTextures(2, textures);
+
+    glfwTerminate();
+    return 0;
+}
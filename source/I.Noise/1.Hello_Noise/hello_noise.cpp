@@ -2,6 +2,8 @@
 #include <GLFW/glfw3.h>
 #include <find_resource.h>
 #include <glad/glad.h>
+#include <heightmap.h>
+#include <job_system.h>
 #include <shader.h>
 
 #include <iostream>
@@ -116,69 +118,30 @@ int main() {
             new float[mapWidth * mapWidth]; // 2D heightmap to create terrain
     std::cout << mapWidth << std::endl;
 
-    GLubyte* texData = new GLubyte[mapWidth * mapWidth * 3];
+    // One 16 bit red channel per texel
+    GLushort* texData = new GLushort[mapWidth * mapWidth];
 
-    for (int x = 0; x < mapWidth; x++) {
-        for (int y = 0; y < mapWidth; y++) {
-            // One dimension index
-            int i = ((x)*mapWidth) + y;
-            heightMap[i] = myNoise.GetNoise((float)x, (float)y);
-        }
-    }
-
-    float max = 0.0f;
-    float min = 2.0f;
-
-    for (int i = 0; i < mapWidth * mapWidth; i++) {
-        if (heightMap[i] > max) {
-            max = heightMap[i];
-        }
-        if (heightMap[i] < min) {
-            min = heightMap[i];
-        }
-    }
-
-    float m = 1 / (max - min);
-    float c1 = 0 - (m * min);
-    float c2 = 0 - (m * min);
+    // Row major, one GetNoise() sample per texel, 64x64 tiles spread over
+    // one worker per core. Min/max come out of the generation pass, then one
+    // pass normalizes and writes the grey texels
+    JobSystem jobSystem;
+    HeightmapGenerator generator(jobSystem);
+    HeightRange range =
+            generator.generate(myNoise, heightMap, mapWidth, mapWidth);
 
-    std::cout << "\nMinimax Before\n";
-    std::cout << "\tMax: " << max << std::endl;
-    std::cout << "\tMin: " << min << std::endl;
-
-    if (c1 != c2) {
-        std::cout << "Ummm, help?" << std::endl;
-    }
-
-    max = 0.0f;
-    min = 2.0f;
-
-    for (int i = 0; i < mapWidth * mapWidth; i++) {
-        // std::cout << std::endl;
-        heightMap[i] = (m * heightMap[i]) + c1;
-        if (heightMap[i] > max) {
-            max = heightMap[i];
-        }
-        if (heightMap[i] < min) {
-            min = heightMap[i];
-        }
-
-            // y = 3x;
-        int colorIndex = (3 * i);
-        GLubyte colorVal = (GLubyte)(255 * heightMap[i]);
-        texData[colorIndex] = colorVal;
-        texData[colorIndex + 1] = colorVal;
-        texData[colorIndex + 2] = colorVal;
-    }
+    std::cout << "\nMinimax\n";
+    std::cout << "\tMax: " << range.max << std::endl;
+    std::cout << "\tMin: " << range.min << std::endl;
 
-    std::cout << "\nMinimax After\n";
-    std::cout << "\tMax: " << max << std::endl;
-    std::cout << "\tMin: " << min << std::endl;
+    generator.quantize(heightMap, mapWidth, mapWidth, range, texData);
 
     unsigned int texture;
     glGenTextures(1, &texture);
     glBindTexture(GL_TEXTURE_2D, texture);
     // glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    // Spread the single red channel to grey
+    GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
     float color[] = {1, 1, 1, 1};
@@ -188,18 +151,16 @@ int main() {
 
     std::cout << (int)texData[0] << " " << (int)texData[1] << " "
               << (int)texData[2] << std::endl;
-    std::cout << (int)texData[765] << " " << (int)texData[766] << " "
-              << (int)texData[767] << std::endl;
 
     // Pass the noise
     glTexImage2D(GL_TEXTURE_2D,
             0,
-            GL_RGB,
+            GL_R16,
             mapWidth,
             mapWidth,
             0,
-            GL_RGB,
-            GL_UNSIGNED_BYTE,
+            GL_RED,
+            GL_UNSIGNED_SHORT,
             texData);
 
     delete[] heightMap;
@@ -5,10 +5,12 @@ in vec3 ourColor;
 in vec2 TexCoord;
 
 uniform sampler2D ourTexture;
+// The map is stored toroidally, texOffset is where the view starts in it
+uniform vec2 texOffset;
 
 vec4 texColor;
 
 void main() {
-    texColor = texture2D(ourTexture, TexCoord);
+    texColor = texture(ourTexture, TexCoord + texOffset);
     FragColor = vec4(texColor.rgb, 1);
 }
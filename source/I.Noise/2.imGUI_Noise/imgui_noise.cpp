@@ -2,9 +2,21 @@
 #include <GLFW/glfw3.h>
 #include <find_resource.h>
 #include <glad/glad.h>
+#include <heightmap.h>
+#include <job_system.h>
 #include <shader.h>
+#include <stream_buffer.h>
 
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -28,91 +40,570 @@ void processInput(GLFWwindow* window) {
     }
 }
 
+// Single channel heightmap textures, drawn grey through the swizzle set on
+// the texture
+struct HeightmapFormat {
+    GLint internalFormat;
+    GLenum type;
+    int texelSize;
+};
+const HeightmapFormat heightmapFormats[] = {
+        {GL_R8, GL_UNSIGNED_BYTE, 1},
+        {GL_R16, GL_UNSIGNED_SHORT, 2},
+        {GL_R32F, GL_FLOAT, 4}};
+int heightmapFormat = 1; // R16
+
 int mapWidth = 1024;
-GLubyte* texData = new GLubyte[mapWidth * mapWidth * 3];
 FastNoise myNoise; // Create a FastNoise object
 FastNoise lookupNoise;
+JobSystem jobSystem; // One worker per core
+HeightmapGenerator heightmapGenerator(jobSystem);
+
+// Pan and zoom: the view is the mapWidth * mapWidth window of world texels
+// starting at (viewX, viewY), sampled at viewX * f and so on. Texture row 0
+// is drawn at the bottom, so y grows upwards.
+float viewX = 0.0f;
+float viewY = 0.0f;
+int requestedX = 0;
+int requestedY = 0;
+// Bakes the strips a scroll exposes, on the render thread. Its own small
+// pool, JobSystem::wait() waits for the whole pool and would otherwise block
+// the frame until the background bake is done.
+JobSystem panJobSystem(2);
+HeightmapGenerator panGenerator(panJobSystem);
+
+// Progressive preview: a request is baked at 1/8, 1/4, 1/2 and then full
+// resolution, and each level is shown as soon as it is done. Uploads are cut
+// into row bands so a frame never spends more than uploadBudget on them.
+const int previewSteps[] = {8, 4, 2, 1};
+const int previewStepCount = 4;
+// Each preview is uploaded into its own mip level (step 2^n into level n) of
+// storage allocated once per format, so regenerating never reallocates
+const int previewLevels = 4;
+const double uploadBudget = 0.004; // Seconds per frame
+const int uploadBandRows = 64;
+bool progressivePreview = true;
+
+// Background regeneration: the render loop posts a copy of the settings, the
+// noise worker bakes it and the render loop uploads the newest finished map
+// into the texture that is not on screen.
+struct NoiseRequest {
+    FastNoise noise;
+    FastNoise lookup;
+    int originX;
+    int originY;
+    int format;
+    bool progressive;
+    unsigned int generation;
+};
 
-void generateNoiseTexture(float frequency, FastNoise::NoiseType noiseType) {
-    myNoise.SetNoiseType(noiseType); // Set the desired noise type
-    myNoise.SetFrequency(frequency);
-    // myNoise.SetCellularDistanceFunction(FastNoise::Natural);
-
-    float* heightMap =
-            new float[mapWidth * mapWidth]; // 2D heightmap to create terrain
+std::thread noiseWorker;
+std::mutex requestMutex;
+std::condition_variable requestCondition;
+NoiseRequest pendingRequest;
+bool hasPendingRequest = false;
+bool stopNoiseWorker = false;
+// Bumped by every request, tiles still queued for an older one are skipped
+std::atomic<unsigned int> latestGeneration(0);
+
+// Where a texture's texels sit in the world. Textures are addressed
+// toroidally: world texel (x, y) is stored at texel
+// ((offsetX + x - originX) mod mapWidth, (offsetY + y - originY) mod mapWidth)
+// so a scroll moves the offsets and overwrites only the texels that left the
+// view, instead of shifting everything else.
+struct NoiseWindow {
+    int originX;
+    int originY;
+    int offsetX;
+    int offsetY;
+    int level; // Mip level holding the map, 0 is full resolution
+    unsigned int generation;
+    HeightRange range; // Baked range, scrolled in strips are quantized to it
+};
 
-    for (int x = 0; x < mapWidth; x++) {
-        for (int y = 0; y < mapWidth; y++) {
-            // One dimension index
-            int i = ((x)*mapWidth) + y;
-            heightMap[i] = myNoise.GetNoise((float)x, (float)y);
+// Four buffers sized for the widest format (R32F): the worker fills one
+// while another waits to be uploaded, the render loop may still be uploading
+// a third over several frames and the GPU may still be reading the last. The
+// indices and fences are guarded by resultMutex, the worker never writes the
+// ready or uploading buffer or one with a pending fence.
+// With GL_ARB_buffer_storage the buffers are slices of one persistently
+// mapped pixel buffer, so the worker quantizes straight into memory the GPU
+// pulls texels from. Otherwise they live in client memory and every band is
+// copied through the uploadRing.
+const int bufferCount = 4;
+const size_t bufferBytes = (size_t)mapWidth * mapWidth * sizeof(float);
+std::mutex resultMutex;
+std::condition_variable bufferCondition;
+GLubyte* texData[bufferCount] = {};
+GLsync bufferFences[bufferCount] = {};
+unsigned int stagingBuffer = 0;
+std::unique_ptr<StreamBuffer> uploadRing;
+int readyBuffer = -1;
+int readyFormat = 0;
+int readySize = 0;
+NoiseWindow readyWindow = {};
+int uploadingBuffer = -1;
+
+void createStagingBuffers() {
+    if (GLAD_GL_ARB_buffer_storage) {
+        GLbitfield flags =
+                GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &stagingBuffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer);
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER,
+                (GLsizeiptr)(bufferCount * bufferBytes),
+                NULL,
+                flags);
+        GLubyte* data = (GLubyte*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+                0,
+                (GLsizeiptr)(bufferCount * bufferBytes),
+                flags);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (data != NULL) {
+            for (int i = 0; i < bufferCount; i++) {
+                texData[i] = data + i * bufferBytes;
+            }
+            return;
         }
+        glDeleteBuffers(1, &stagingBuffer);
+        stagingBuffer = 0;
     }
 
-    float max = 0.0f;
-    float min = 2.0f;
+    for (int i = 0; i < bufferCount; i++) {
+        texData[i] = new GLubyte[bufferBytes];
+    }
+    // A whole full resolution map per frame in flight
+    uploadRing.reset(new StreamBuffer(
+            GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)bufferBytes));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
 
-    for (int i = 0; i < mapWidth * mapWidth; i++) {
-        if (heightMap[i] > max) {
-            max = heightMap[i];
+void destroyStagingBuffers() {
+    for (int i = 0; i < bufferCount; i++) {
+        if (bufferFences[i] != 0) {
+            glDeleteSync(bufferFences[i]);
+            bufferFences[i] = 0;
         }
-        if (heightMap[i] < min) {
-            min = heightMap[i];
+    }
+    if (stagingBuffer != 0) {
+        // Unmapped along with it
+        glDeleteBuffers(1, &stagingBuffer);
+        stagingBuffer = 0;
+    } else {
+        for (int i = 0; i < bufferCount; i++) {
+            delete[] texData[i];
         }
+        uploadRing->release();
     }
+}
 
-    float m = 1 / (max - min);
-    float c1 = 0 - (m * min);
-    float c2 = 0 - (m * min);
+// First buffer the worker may write, -1 if all are taken. Called with
+// resultMutex held.
+int findFreeBuffer() {
+    for (int i = 0; i < bufferCount; i++) {
+        if (i != readyBuffer && i != uploadingBuffer && bufferFences[i] == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
 
-    std::cout << "\nMinimax Before\n";
-    std::cout << "\tMax: " << max << std::endl;
-    std::cout << "\tMin: " << min << std::endl;
+// Writes width * height heights as texels of format into out
+void quantizeNoise(HeightmapGenerator& generator,
+        const float* heightMap,
+        int width,
+        int height,
+        HeightRange range,
+        int format,
+        GLubyte* out) {
+    switch (heightmapFormats[format].type) {
+    case GL_UNSIGNED_SHORT:
+        generator.quantize(
+                heightMap, width, height, range, (unsigned short*)out);
+        break;
+    case GL_FLOAT:
+        generator.quantize(heightMap, width, height, range, (float*)out);
+        break;
+    default:
+        generator.quantize(heightMap, width, height, range, out);
+        break;
+    }
+}
 
-    if (c1 != c2) {
-        std::cout << "Ummm, help?" << std::endl;
+HeightRange generateNoiseTexture(const NoiseRequest& request,
+        int step,
+        float* heightMap,
+        GLubyte* out) {
+    int size = mapWidth / step;
+
+    // Row major, one GetNoise() sample every step texels. Min/max come out of
+    // the generation pass, then one pass normalizes and writes the grey texels
+    HeightRange range = heightmapGenerator.generateWindow(request.noise,
+            heightMap,
+            request.originX,
+            request.originY,
+            size,
+            size,
+            step,
+            &latestGeneration,
+            request.generation);
+    if (latestGeneration != request.generation) {
+        return range;
     }
 
-    max = 0.0f;
-    min = 2.0f;
+    quantizeNoise(heightmapGenerator,
+            heightMap,
+            size,
+            size,
+            range,
+            request.format,
+            out);
+    return range;
+}
 
-    for (int i = 0; i < mapWidth * mapWidth; i++) {
-        // std::cout << std::endl;
-        heightMap[i] = (m * heightMap[i]) + c1;
-        if (heightMap[i] > max) {
-            max = heightMap[i];
-        }
-        if (heightMap[i] < min) {
-            min = heightMap[i];
+void noiseWorkerLoop() {
+    float* heightMap =
+            new float[mapWidth * mapWidth]; // 2D heightmap to create terrain
+    NoiseRequest request;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(requestMutex);
+            requestCondition.wait(lock,
+                    [] { return hasPendingRequest || stopNoiseWorker; });
+            if (stopNoiseWorker) {
+                break;
+            }
+            request = pendingRequest;
+            hasPendingRequest = false;
         }
+        // Point the copy at its own lookup, the UI may be editing the global
+        request.noise.SetCellularNoiseLookup(&request.lookup);
+
+        int firstLevel = request.progressive ? 0 : previewStepCount - 1;
+        for (int level = firstLevel; level < previewStepCount; level++) {
+            int buffer = -1;
+            {
+                // Every buffer can be busy for a frame or two while the GPU
+                // finishes reading them
+                std::unique_lock<std::mutex> lock(resultMutex);
+                bufferCondition.wait(lock, [&] {
+                    buffer = findFreeBuffer();
+                    return buffer >= 0 ||
+                           latestGeneration != request.generation;
+                });
+            }
+            if (buffer < 0) {
+                break;
+            }
 
-        // y = 3x;
-        int colorIndex = (3 * i);
-        GLubyte colorVal = (GLubyte)(255 * heightMap[i]);
-        texData[colorIndex] = colorVal;
-        texData[colorIndex + 1] = colorVal;
-        texData[colorIndex + 2] = colorVal;
-    }
+            int step = previewSteps[level];
+            HeightRange range = generateNoiseTexture(
+                    request, step, heightMap, texData[buffer]);
+            if (latestGeneration != request.generation) {
+                break; // Superseded, a newer request is already waiting
+            }
 
-    std::cout << "\nMinimax After\n";
-    std::cout << "\tMax: " << max << std::endl;
-    std::cout << "\tMin: " << min << std::endl;
+            std::lock_guard<std::mutex> lock(resultMutex);
+            readyBuffer = buffer;
+            readyFormat = request.format;
+            readySize = mapWidth / step;
+            readyWindow.originX = request.originX;
+            readyWindow.originY = request.originY;
+            readyWindow.generation = request.generation;
+            readyWindow.range = range;
+        }
+    }
 
     delete[] heightMap;
 }
 
 void updateNoise(float f, FastNoise::NoiseType current_noise_type) {
-    generateNoiseTexture(f, (FastNoise::NoiseType)current_noise_type);
+    myNoise.SetNoiseType(current_noise_type); // Set the desired noise type
+    myNoise.SetFrequency(f);
+    requestedX = (int)std::lround(viewX);
+    requestedY = (int)std::lround(viewY);
+
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        pendingRequest.noise = myNoise;
+        pendingRequest.lookup = lookupNoise;
+        pendingRequest.originX = requestedX;
+        pendingRequest.originY = requestedY;
+        pendingRequest.format = heightmapFormat;
+        pendingRequest.progressive = progressivePreview;
+        pendingRequest.generation = ++latestGeneration;
+        hasPendingRequest = true;
+    }
+    requestCondition.notify_one();
+}
+
+// Immutable storage for every preview level, the texture is recreated when
+// the format changes since immutable storage can't be respecified
+void allocateNoiseTexture(unsigned int& texture, int format) {
+    if (texture != 0) {
+        glDeleteTextures(1, &texture);
+    }
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    // Spread the single red channel to grey
+    GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    // Toroidal addressing, filtering across the seam blends world neighbours
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    const HeightmapFormat& texFormat = heightmapFormats[format];
+    if (GLAD_GL_ARB_texture_storage) {
+        glTexStorage2D(GL_TEXTURE_2D,
+                previewLevels,
+                (GLenum)texFormat.internalFormat,
+                mapWidth,
+                mapWidth);
+    } else {
+        // Same thing with mutable storage, still only allocated here
+        for (int level = 0; level < previewLevels; level++) {
+            glTexImage2D(GL_TEXTURE_2D,
+                    level,
+                    texFormat.internalFormat,
+                    mapWidth >> level,
+                    mapWidth >> level,
+                    0,
+                    GL_RED,
+                    texFormat.type,
+                    NULL);
+        }
+    }
+}
+
+// Hands buffers whose uploads the GPU has finished back to the worker
+void retireStagingBuffers() {
+    bool freed = false;
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        for (int i = 0; i < bufferCount; i++) {
+            if (bufferFences[i] != 0 &&
+                    glClientWaitSync(bufferFences[i], 0, 0) !=
+                            GL_TIMEOUT_EXPIRED) {
+                glDeleteSync(bufferFences[i]);
+                bufferFences[i] = 0;
+                freed = true;
+            }
+        }
+    }
+    if (freed) {
+        bufferCondition.notify_one();
+    }
+}
+
+// Uploads the newest finished map into texture, a band of rows at a time
+// until the frame's budget is spent. Returns true once a whole map is in.
+// The copies are queued from a pixel buffer, so they neither block on the
+// driver nor reallocate the texture.
+bool uploadReadyNoise(
+        unsigned int& texture, int& textureFormat, NoiseWindow& window) {
+    static int uploadFormat = 0, uploadSize = 0, uploadLevel = 0,
+               uploadedRows = 0;
+    static NoiseWindow uploadWindow = {};
+
+    retireStagingBuffers();
+    bool fullMap = false;
+    {
+        // A newer map replaces one that is only partly uploaded
+        std::lock_guard<std::mutex> lock(resultMutex);
+        if (readyBuffer >= 0) {
+            if (uploadingBuffer >= 0 && stagingBuffer != 0) {
+                bufferFences[uploadingBuffer] =
+                        glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            }
+            uploadingBuffer = readyBuffer;
+            uploadFormat = readyFormat;
+            uploadSize = readySize;
+            uploadLevel = 0;
+            while ((mapWidth >> uploadLevel) > uploadSize) {
+                uploadLevel++;
+            }
+            uploadWindow = readyWindow;
+            uploadWindow.level = uploadLevel;
+            uploadedRows = 0;
+            readyBuffer = -1;
+            fullMap = uploadSize == mapWidth;
+        }
+    }
+    // Once per request, for the full resolution map rather than each preview
+    if (fullMap) {
+        std::cout << "Minimax: " << uploadWindow.range.min << " to "
+                  << uploadWindow.range.max << std::endl;
+    }
+    if (uploadingBuffer < 0) {
+        return false;
+    }
+
+    if (textureFormat != uploadFormat) {
+        allocateNoiseTexture(texture, uploadFormat);
+        textureFormat = uploadFormat;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+
     // Pass the noise
-    glTexImage2D(GL_TEXTURE_2D,
-            0,
-            GL_RGB,
-            mapWidth,
-            mapWidth,
-            0,
-            GL_RGB,
-            GL_UNSIGNED_BYTE,
-            texData);
+    const HeightmapFormat& format = heightmapFormats[uploadFormat];
+    size_t rowBytes = (size_t)(uploadSize * format.texelSize);
+    if (stagingBuffer != 0) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer);
+    } else {
+        uploadRing->beginFrame();
+    }
+    double start = glfwGetTime();
+    while (uploadedRows < uploadSize &&
+            glfwGetTime() - start < uploadBudget) {
+        int rows = uploadSize - uploadedRows < uploadBandRows
+                ? uploadSize - uploadedRows
+                : uploadBandRows;
+        size_t bandStart = (size_t)uploadedRows * rowBytes;
+        size_t bandBytes = (size_t)rows * rowBytes;
+
+        // With a pixel buffer bound the pointer is an offset into it
+        size_t pixels;
+        if (stagingBuffer != 0) {
+            pixels = (size_t)uploadingBuffer * bufferBytes + bandStart;
+        } else {
+            StreamAllocation band = uploadRing->map((GLsizeiptr)bandBytes);
+            if (band.data == NULL) {
+                break; // Ring full for this frame, carry on next frame
+            }
+            std::memcpy(band.data,
+                    texData[uploadingBuffer] + bandStart,
+                    bandBytes);
+            uploadRing->unmap();
+            pixels = (size_t)band.offset;
+        }
+        glTexSubImage2D(GL_TEXTURE_2D,
+                uploadLevel,
+                0,
+                uploadedRows,
+                uploadSize,
+                rows,
+                GL_RED,
+                format.type,
+                (const void*)pixels);
+        uploadedRows += rows;
+    }
+    if (stagingBuffer == 0) {
+        uploadRing->endFrame();
+    }
+    // Client memory uploads (ImGui's font atlas) need it unbound
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (uploadedRows < uploadSize) {
+        return false;
+    }
+
+    // Sample just the level that was filled
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, uploadLevel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, uploadLevel);
+    window = uploadWindow;
+
+    std::lock_guard<std::mutex> lock(resultMutex);
+    if (stagingBuffer != 0) {
+        bufferFences[uploadingBuffer] =
+                glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    uploadingBuffer = -1;
+    return true;
+}
+
+int wrapTexel(int texel) {
+    texel %= mapWidth;
+    return texel < 0 ? texel + mapWidth : texel;
+}
+
+// Bakes the width * height block of window starting at window texel (x, y)
+// and uploads it into the bound texture, split where it wraps around the
+// texture edges
+void bakeNoiseStrip(const NoiseWindow& window,
+        int format,
+        int x,
+        int y,
+        int width,
+        int height) {
+    static std::vector<float> heights;
+    static std::vector<GLubyte> texels;
+    const HeightmapFormat& texFormat = heightmapFormats[format];
+    heights.resize((size_t)width * height);
+    texels.resize((size_t)width * height * texFormat.texelSize);
+
+    panGenerator.generateWindow(myNoise,
+            &heights[0],
+            window.originX + x,
+            window.originY + y,
+            width,
+            height);
+    quantizeNoise(panGenerator,
+            &heights[0],
+            width,
+            height,
+            window.range,
+            format,
+            &texels[0]);
+
+    int texX = wrapTexel(window.offsetX + x);
+    int texY = wrapTexel(window.offsetY + y);
+    int firstWidth = width < mapWidth - texX ? width : mapWidth - texX;
+    int firstHeight = height < mapWidth - texY ? height : mapWidth - texY;
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
+    for (int part = 0; part < 4; part++) {
+        int skipX = (part & 1) ? firstWidth : 0;
+        int skipY = (part & 2) ? firstHeight : 0;
+        int partWidth = (part & 1) ? width - firstWidth : firstWidth;
+        int partHeight = (part & 2) ? height - firstHeight : firstHeight;
+        if (partWidth == 0 || partHeight == 0) {
+            continue;
+        }
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, skipX);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, skipY);
+        glTexSubImage2D(GL_TEXTURE_2D,
+                0,
+                wrapTexel(texX + skipX),
+                wrapTexel(texY + skipY),
+                partWidth,
+                partHeight,
+                GL_RED,
+                texFormat.type,
+                &texels[0]);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+}
+
+// Moves a full resolution window less than a map away to (originX, originY).
+// Noise only depends on position, so the texels still in view are kept and
+// only the columns and rows scrolling in are baked, the cost follows the
+// newly visible area. The corner both strips cover is baked twice.
+void scrollNoise(unsigned int texture,
+        int format,
+        NoiseWindow& window,
+        int originX,
+        int originY) {
+    int dx = originX - window.originX;
+    int dy = originY - window.originY;
+    window.originX = originX;
+    window.originY = originY;
+    window.offsetX = wrapTexel(window.offsetX + dx);
+    window.offsetY = wrapTexel(window.offsetY + dy);
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (dx != 0) {
+        int width = std::abs(dx);
+        int x = dx > 0 ? mapWidth - width : 0;
+        bakeNoiseStrip(window, format, x, 0, width, mapWidth);
+    }
+    if (dy != 0) {
+        int height = std::abs(dy);
+        int y = dy > 0 ? mapWidth - height : 0;
+        bakeNoiseStrip(window, format, 0, y, mapWidth, height);
+    }
 }
 
 void showGeneralNoiseSettings(float* c_f, int* c_noise_type, int* c_seed) {
@@ -211,41 +702,27 @@ int main() {
 
     Resources resources;
     std::string vertex =
-            resources.getShaderPath("/I.Noise/1.Hello_Noise/vertex.glsl");
+            resources.getShaderPath("/I.Noise/2.imGUI_Noise/vertex.glsl");
     std::string fragment =
-            resources.getShaderPath("/I.Noise/1.Hello_Noise/fragment.glsl");
+            resources.getShaderPath("/I.Noise/2.imGUI_Noise/fragment.glsl");
 
     Shader ourShader(vertex.c_str(), fragment.c_str());
-
-    // generateNoiseTexture(0.02f, FastNoise::Perlin);
-    generateNoiseTexture(0.02f, (FastNoise::NoiseType)2);
-
-    unsigned int texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    // glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    float color[] = {1, 1, 1, 1};
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, color);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-    std::cout << (int)texData[0] << " " << (int)texData[1] << " "
-              << (int)texData[2] << std::endl;
-    std::cout << (int)texData[765] << " " << (int)texData[766] << " "
-              << (int)texData[767] << std::endl;
-
-    // Pass the noise
-    glTexImage2D(GL_TEXTURE_2D,
-            0,
-            GL_RGB,
-            mapWidth,
-            mapWidth,
-            0,
-            GL_RGB,
-            GL_UNSIGNED_BYTE,
-            texData);
+    // Pick up edits to the .glsl files without losing the current map
+    ourShader.watch();
+
+    // Double buffered: one texture is drawn while the next map is uploaded
+    // into the other, then they swap. Storage is allocated by the first
+    // upload in each format.
+    unsigned int textures[2] = {0, 0};
+    int textureFormats[2] = {-1, -1};
+    NoiseWindow windows[2] = {};
+    int frontTexture = 0;
+    // R8 rows are not 4 byte aligned for every width
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    createStagingBuffers();
+
+    // The first map is requested on the first frame
+    noiseWorker = std::thread(noiseWorkerLoop);
 
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
@@ -304,14 +781,27 @@ int main() {
     static int nl_previous_noise_type = 2, nl_current_noise_type = 2;
     static int nl_previous_seed = 0, nl_current_seed = 0;
 
+    // Texture
+    static int previous_format = heightmapFormat,
+               current_format = heightmapFormat;
+
     while (!glfwWindowShouldClose(window)) {
         // Input
         processInput(window);
+        ourShader.reloadIfChanged();
 
         if (f != last_f || previous_noise_type != current_noise_type ||
                 current_seed != previous_seed) {
             myNoise.SetSeed(current_seed);
 
+            if (last_f != 0.0f) {
+                // Zoom about the centre of the view: world texel c samples
+                // c * f, so it moves to c * last_f / f
+                float half = (float)mapWidth * 0.5f;
+                viewX = ((viewX + half) * last_f / f) - half;
+                viewY = ((viewY + half) * last_f / f) - half;
+            }
+
             std::cout << "Last Noise: " << previous_noise_type << " "
                       << noises[previous_noise_type]
                       << "\tCurrent Noise: " << current_noise_type << " "
@@ -365,11 +855,57 @@ int main() {
                 nl_previous_seed = nl_current_seed;
             }
         }
+        if (previous_format != current_format) {
+            heightmapFormat = current_format;
+            previous_format = current_format;
+
+            updateNoise(f, (FastNoise::NoiseType)current_noise_type);
+        }
+
+        // Scroll the full resolution map in strips when it is the newest
+        // one, otherwise bake the whole view where it now is
+        int originX = (int)std::lround(viewX);
+        int originY = (int)std::lround(viewY);
+        NoiseWindow& front = windows[frontTexture];
+        if (originX != front.originX || originY != front.originY) {
+            if (textureFormats[frontTexture] >= 0 && front.level == 0 &&
+                    front.generation == latestGeneration &&
+                    std::abs(originX - front.originX) < mapWidth &&
+                    std::abs(originY - front.originY) < mapWidth) {
+                scrollNoise(textures[frontTexture],
+                        textureFormats[frontTexture],
+                        front,
+                        originX,
+                        originY);
+            } else if (originX != requestedX || originY != requestedY) {
+                updateNoise(f, (FastNoise::NoiseType)current_noise_type);
+            }
+        }
+
+        if (uploadReadyNoise(textures[1 - frontTexture],
+                    textureFormats[1 - frontTexture],
+                    windows[1 - frontTexture])) {
+            frontTexture = 1 - frontTexture;
+        }
+
         // Start the Dear ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
+        // Drag to pan and scroll to zoom, the quad covers 90% of the window
+        if (!io.WantCaptureMouse) {
+            if (io.MouseDown[0]) {
+                float texels = (float)mapWidth / 0.9f;
+                viewX -= io.MouseDelta.x * texels / io.DisplaySize.x;
+                viewY += io.MouseDelta.y * texels / io.DisplaySize.y;
+            }
+            if (io.MouseWheel != 0.0f) {
+                f *= std::pow(0.9f, io.MouseWheel);
+                f = f < 0.001f ? 0.001f : (f > 1.0f ? 1.0f : f);
+            }
+        }
+
         // 1. Show the big demo window
         // (Most of the sample code is in ImGui::ShowDemoWindow()!
         // You can browse its code to learn more about Dear ImGui!).
@@ -420,6 +956,15 @@ int main() {
                         1.0f); // Edit 1 float using a slider from 0.0f to 1.0f
             }
 
+            ImGui::Text("Texture");
+            ImGui::Combo("Format", &current_format, "R8\0R16\0R32F\0\0");
+            ImGui::Checkbox("Progressive preview", &progressivePreview);
+
+            ImGui::Text("View");
+            ImGui::Text("Drag to pan, scroll to zoom");
+            ImGui::Text("Origin %d, %d", windows[frontTexture].originX,
+                    windows[frontTexture].originY);
+
             ImGui::Text("Application average %.3f ms/frame (%.1f FPS)",
                     1000.0f / ImGui::GetIO().Framerate,
                     ImGui::GetIO().Framerate);
@@ -448,7 +993,10 @@ int main() {
 
         glClear(GL_COLOR_BUFFER_BIT);
         ourShader.use();
-        glBindTexture(GL_TEXTURE_2D, texture);
+        ourShader.setVec2("texOffset",
+                (float)windows[frontTexture].offsetX / (float)mapWidth,
+                (float)windows[frontTexture].offsetY / (float)mapWidth);
+        glBindTexture(GL_TEXTURE_2D, textures[frontTexture]);
         glBindVertexArray(VAO);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
         glBindVertexArray(0);
@@ -460,12 +1008,26 @@ int main() {
         glfwPollEvents();
     }
 
-    delete[] texData;
+    // Stop the noise worker, cancelling any map still being baked
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        stopNoiseWorker = true;
+    }
+    {
+        // Under the lock so a worker waiting for a buffer can't miss it
+        std::lock_guard<std::mutex> lock(resultMutex);
+        latestGeneration++;
+    }
+    requestCondition.notify_one();
+    bufferCondition.notify_one();
+    noiseWorker.join();
+
+    destroyStagingBuffers();
     // optional: de-allocate all resources once they've outlived their purpose:
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
-    glDeleteTextures(1, &texture);
+    glDeleteTextures(2, textures);
 
     glfwTerminate();
     return 0;
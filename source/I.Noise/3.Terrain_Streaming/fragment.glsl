@@ -0,0 +1,21 @@
+#version 330 core
+out vec4 FragColor;
+
+in float Height;
+in float Distance;
+
+uniform vec3 fogColor;
+uniform float fogEnd;
+
+void main() {
+    // Water, sand, grass, rock and snow by height
+    vec3 color = vec3(0.15, 0.3, 0.55);
+    color = mix(color, vec3(0.76, 0.7, 0.5), step(-0.25, Height));
+    color = mix(color, vec3(0.25, 0.5, 0.2), step(-0.2, Height));
+    color = mix(color, vec3(0.45, 0.4, 0.35), step(0.3, Height));
+    color = mix(color, vec3(0.95, 0.95, 0.95), step(0.55, Height));
+
+    // Fade into the clear colour before the edge of the streamed area
+    float fog = clamp(Distance / fogEnd, 0.0, 1.0);
+    FragColor = vec4(mix(color, fogColor, fog * fog), 1.0);
+}
@@ -0,0 +1,294 @@
+#include <FastNoise.h>
+#include <GLFW/glfw3.h>
+#include <find_resource.h>
+#include <glad/glad.h>
+#include <job_system.h>
+#include <shader.h>
+#include <terrain.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+int screenWidth = 1000;
+int screenHeight = 800;
+
+#if defined(__GNUC__) || defined(__GNUG__)
+void framebuffer_size_callback(
+        __attribute__((unused)) GLFWwindow* window, int width, int height) {
+    screenWidth = width;
+    screenHeight = height;
+    glViewport(0, 0, width, height);
+}
+#elif defined(_MSC_VER)
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    (void)window;
+    screenWidth = width;
+    screenHeight = height;
+    glViewport(0, 0, width, height);
+}
+#endif
+
+// A/D turn, W/S speed up and slow down
+void processInput(GLFWwindow* window,
+        float deltaTime,
+        float& yaw,
+        float& speed) {
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+        glfwSetWindowShouldClose(window, true);
+    }
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
+        yaw -= 60.0f * deltaTime;
+    }
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
+        yaw += 60.0f * deltaTime;
+    }
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
+        speed = std::fmin(speed * (1.0f + deltaTime), 2000.0f);
+    }
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
+        speed = std::fmax(speed * (1.0f - deltaTime), 10.0f);
+    }
+}
+
+// GPU side of a resident chunk: its own height buffer on the shared grid
+struct ChunkMesh {
+    unsigned int VAO;
+    unsigned int heightVBO;
+};
+typedef std::unordered_map<ChunkCoord, ChunkMesh, ChunkCoordHash> ChunkMeshMap;
+
+int main(int argc, char** argv) {
+    // The cache budget in MiB can be overridden from the command line
+    size_t budgetMiB = 16;
+    if (argc > 1) {
+        budgetMiB = (size_t)std::strtoul(argv[1], NULL, 10);
+    }
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWwindow* window = glfwCreateWindow(
+            screenWidth, screenHeight, "Terrain Streaming", NULL, NULL);
+    if (window == NULL) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    glViewport(0, 0, screenWidth, screenHeight);
+
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    FastNoise noise;
+    noise.SetNoiseType(FastNoise::SimplexFractal);
+    noise.SetFrequency(0.004f);
+    noise.SetFractalOctaves(5);
+
+    const int chunkSize = 64;
+    const int viewRadius = 12; // Chunks
+    const float heightScale = 60.0f;
+    JobSystem jobSystem;
+    TerrainStreamer streamer(
+            jobSystem, noise, chunkSize, budgetMiB * 1024 * 1024);
+
+    // Every chunk is drawn from the same (chunkSize + 1)^2 grid of x, z
+    // offsets and index buffer, only the heights are per chunk
+    const int samples = chunkSize + 1;
+    std::vector<float> grid;
+    for (int z = 0; z < samples; z++) {
+        for (int x = 0; x < samples; x++) {
+            grid.push_back((float)x);
+            grid.push_back((float)z);
+        }
+    }
+    std::vector<unsigned short> indices;
+    for (int z = 0; z < chunkSize; z++) {
+        for (int x = 0; x < chunkSize; x++) {
+            unsigned short corner = (unsigned short)(z * samples + x);
+            unsigned short right = (unsigned short)(corner + 1);
+            unsigned short below = (unsigned short)(corner + samples);
+            unsigned short across = (unsigned short)(below + 1);
+            unsigned short quad[] = {
+                    corner, below, right, right, below, across};
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+
+    unsigned int gridVBO, EBO;
+    glGenBuffers(1, &gridVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
+    glBufferData(GL_ARRAY_BUFFER,
+            (GLsizeiptr)(grid.size() * sizeof(float)),
+            &grid[0],
+            GL_STATIC_DRAW);
+    glGenBuffers(1, &EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+            (GLsizeiptr)(indices.size() * sizeof(unsigned short)),
+            &indices[0],
+            GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    ChunkMeshMap meshes;
+
+    Resources resources;
+    std::string vertex = resources.getShaderPath(
+            "/I.Noise/3.Terrain_Streaming/vertex.glsl");
+    std::string fragment = resources.getShaderPath(
+            "/I.Noise/3.Terrain_Streaming/fragment.glsl");
+
+    Shader ourShader(vertex.c_str(), fragment.c_str());
+    ourShader.use();
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    UniformHandle viewLoc = ourShader.getUniform("view");
+    UniformHandle projectionLoc = ourShader.getUniform("projection");
+    UniformHandle originLoc = ourShader.getUniform("chunkOrigin");
+
+    const float farPlane = (float)(viewRadius * chunkSize);
+    const float skyColor[] = {0.55f, 0.7f, 0.85f};
+    ourShader.setFloat("heightScale", heightScale);
+    ourShader.setFloat("fogEnd", farPlane);
+    ourShader.setVec3("fogColor", skyColor[0], skyColor[1], skyColor[2]);
+
+    glm::vec3 position(0.0f);
+    float yaw = 0.0f;
+    float speed = 60.0f; // World units per second
+
+    double lastFrameTime = glfwGetTime();
+    double lastTitleTime = lastFrameTime;
+    unsigned int framesSinceTitle = 0;
+
+    while (!glfwWindowShouldClose(window)) {
+        double now = glfwGetTime();
+        float deltaTime = (float)(now - lastFrameTime);
+        lastFrameTime = now;
+
+        // Input
+        processInput(window, deltaTime, yaw, speed);
+
+        // Fly forward, following the ground below
+        glm::vec3 direction(std::sin(glm::radians(yaw)),
+                0.0f,
+                -std::cos(glm::radians(yaw)));
+        position += direction * speed * deltaTime;
+        float ground =
+                std::fmax(noise.GetNoise(position.x, position.z), 0.0f);
+        position.y = ground * heightScale + 25.0f;
+
+        // Hand finished chunks to the GPU and free the evicted ones, then
+        // queue the ones that came into range
+        streamer.update(position.x, position.z, viewRadius);
+        const std::vector<ChunkCoord>& evicted = streamer.getEvicted();
+        for (size_t i = 0; i < evicted.size(); i++) {
+            ChunkMeshMap::iterator found = meshes.find(evicted[i]);
+            if (found != meshes.end()) {
+                glDeleteVertexArrays(1, &found->second.VAO);
+                glDeleteBuffers(1, &found->second.heightVBO);
+                meshes.erase(found);
+            }
+        }
+        const std::vector<ChunkCoord>& loaded = streamer.getLoaded();
+        for (size_t i = 0; i < loaded.size(); i++) {
+            const TerrainChunk* chunk = streamer.getChunk(loaded[i]);
+            if (chunk == nullptr) {
+                continue; // Evicted in the same update
+            }
+            ChunkMesh mesh;
+            glGenVertexArrays(1, &mesh.VAO);
+            glGenBuffers(1, &mesh.heightVBO);
+            glBindVertexArray(mesh.VAO);
+            glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
+            glVertexAttribPointer(
+                    0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+            glEnableVertexAttribArray(0);
+            glBindBuffer(GL_ARRAY_BUFFER, mesh.heightVBO);
+            glBufferData(GL_ARRAY_BUFFER,
+                    (GLsizeiptr)(chunk->heights.size() * sizeof(float)),
+                    &chunk->heights[0],
+                    GL_STATIC_DRAW);
+            glVertexAttribPointer(
+                    1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+            glEnableVertexAttribArray(1);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+            glBindVertexArray(0);
+            meshes[loaded[i]] = mesh;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glm::mat4 view = glm::lookAt(position,
+                position + direction + glm::vec3(0.0f, -0.3f, 0.0f),
+                glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f),
+                (float)screenWidth / (float)screenHeight,
+                0.5f,
+                farPlane);
+
+        // Draw
+        glClearColor(skyColor[0], skyColor[1], skyColor[2], 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        ourShader.use();
+        ourShader.setMat4(viewLoc, glm::value_ptr(view));
+        ourShader.setMat4(projectionLoc, glm::value_ptr(projection));
+        for (ChunkMeshMap::iterator it = meshes.begin(); it != meshes.end();
+                ++it) {
+            ourShader.setVec2(originLoc,
+                    (float)(it->first.x * chunkSize),
+                    (float)(it->first.z * chunkSize));
+            glBindVertexArray(it->second.VAO);
+            glDrawElements(GL_TRIANGLES,
+                    (GLsizei)indices.size(),
+                    GL_UNSIGNED_SHORT,
+                    (void*)0);
+        }
+        glBindVertexArray(0);
+
+        // Report the cache in the title once a second
+        framesSinceTitle++;
+        if (now - lastTitleTime >= 1.0) {
+            std::ostringstream title;
+            title << "Terrain Streaming - " << streamer.getResidentCount()
+                  << " chunks, " << streamer.getPendingCount() << " pending, "
+                  << streamer.getMemoryUsed() / (1024 * 1024) << " of "
+                  << budgetMiB << " MiB, "
+                  << (now - lastTitleTime) * 1000.0 / framesSinceTitle
+                  << " ms/frame";
+            glfwSetWindowTitle(window, title.str().c_str());
+            lastTitleTime = now;
+            framesSinceTitle = 0;
+        }
+
+        // Check and call events and swap the buffer
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    for (ChunkMeshMap::iterator it = meshes.begin(); it != meshes.end(); ++it) {
+        glDeleteVertexArrays(1, &it->second.VAO);
+        glDeleteBuffers(1, &it->second.heightVBO);
+    }
+    glDeleteBuffers(1, &gridVBO);
+    glDeleteBuffers(1, &EBO);
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec2 aGrid;
+layout (location = 1) in float aHeight;
+
+out float Height;
+out float Distance;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec2 chunkOrigin;
+uniform float heightScale;
+
+void main() {
+    vec4 position = view * vec4(chunkOrigin.x + aGrid.x,
+            aHeight * heightScale,
+            chunkOrigin.y + aGrid.y,
+            1.0);
+    gl_Position = projection * position;
+    Height = aHeight;
+    Distance = length(position.xyz);
+}